@@ -13,7 +13,7 @@ fi
 
 # Compile External Priorities scheduler
 echo "Compiling External Priorities (EP)..."
-g++ -g -O0 -I . -o bin/interrupts_EP interrupts_101116888_101276841_EP.cpp
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/interrupts_EP interrupts_101116888_101276841_EP.cpp
 if [ $? -eq 0 ]; then
     echo "✓ EP compiled successfully"
 else
@@ -23,7 +23,7 @@ fi
 
 # Compile Round Robin scheduler
 echo "Compiling Round Robin (RR)..."
-g++ -g -O0 -I . -o bin/interrupts_RR interrupts_101116888_101276841_RR.cpp
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/interrupts_RR interrupts_101116888_101276841_RR.cpp
 if [ $? -eq 0 ]; then
     echo "✓ RR compiled successfully"
 else
@@ -33,7 +33,7 @@ fi
 
 # Compile External Priorities + Round Robin scheduler
 echo "Compiling EP + RR (EP_RR)..."
-g++ -g -O0 -I . -o bin/interrupts_EP_RR interrupts_101116888_101276841_EP_RR.cpp
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/interrupts_EP_RR interrupts_101116888_101276841_EP_RR.cpp
 if [ $? -eq 0 ]; then
     echo "✓ EP_RR compiled successfully"
 else
@@ -41,6 +41,46 @@ else
     exit 1
 fi
 
+# Compile the binary trace converter
+echo "Compiling trace converter..."
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/trace_convert trace_convert_101116888_101276841.cpp
+if [ $? -eq 0 ]; then
+    echo "✓ trace_convert compiled successfully"
+else
+    echo "✗ trace_convert compilation failed"
+    exit 1
+fi
+
+# Compile the trace query tool
+echo "Compiling trace query..."
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/trace_query trace_query_101116888_101276841.cpp
+if [ $? -eq 0 ]; then
+    echo "✓ trace_query compiled successfully"
+else
+    echo "✗ trace_query compilation failed"
+    exit 1
+fi
+
+# Compile the engine equivalence check
+echo "Compiling engine diff..."
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/engine_diff engine_diff_101116888_101276841.cpp
+if [ $? -eq 0 ]; then
+    echo "✓ engine_diff compiled successfully"
+else
+    echo "✗ engine_diff compilation failed"
+    exit 1
+fi
+
+# Compile the scheduler trace importer
+echo "Compiling scheduler trace importer..."
+g++ -g -O0 -std=c++17 -pthread -I . -o bin/sched_import sched_import_101116888_101276841.cpp
+if [ $? -eq 0 ]; then
+    echo "✓ sched_import compiled successfully"
+else
+    echo "✗ sched_import compilation failed"
+    exit 1
+fi
+
 echo ""
 echo "All schedulers compiled successfully!"
 echo "Run with: ./bin/interrupts_EP <input_file>"
@@ -0,0 +1,393 @@
+/**
+ * @file engine_diff_101116888_101276841.cpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Differential equivalence check of the table engine against the reference loop
+ *
+ * Every workload (the checked-in inputs plus randomly generated ones, each with
+ * random options) is run by every scheduler binary twice, with --engine reference
+ * and --engine soa. The binary traces are compared record by record and the
+ * printed metrics line by line. A mismatch is shrunk to a minimal failing input
+ * (fewer processes, varying bursts and options, smaller values), which is saved next to the
+ * report so it can be replayed directly.
+ */
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_trace.hpp"
+
+#include<atomic>
+#include<filesystem>
+#include<mutex>
+#include<unistd.h>
+
+//Command line option given to both engines, value empty for flags
+typedef std::pair<std::string, std::string> run_option;
+
+//One input file and the options it runs with
+struct workload {
+    std::string                 name;
+    std::vector<PCB>            processes;
+    std::map<int, std::string>  bursts;     // Bursts field of the processes with varying bursts, by PID
+    std::vector<run_option>     options;
+};
+
+const char* POLICIES[] = {"EP", "RR", "EP_RR"};
+
+//------------------------------------WORKLOADS----------------------------------------------
+
+std::string print_workload(const workload &current) {
+    std::stringstream buffer;
+    for(const auto &process : current.processes) {
+        buffer << process.PID << ", " << process.size << ", " << process.arrival_time << ", "
+               << process.processing_time << ", " << process.io_freq << ", " << process.io_duration;
+        auto bursts = current.bursts.find(process.PID);
+        if(bursts != current.bursts.end()) {
+            buffer << ", " << bursts->second;
+        }
+        buffer << std::endl;
+    }
+    return buffer.str();
+}
+
+std::string print_options(const std::vector<run_option> &options) {
+    std::string line;
+    for(const auto &option : options) {
+        line += " " + option.first + (option.second.empty() ? "" : " " + option.second);
+    }
+    return line;
+}
+
+bool read_workload(const std::string &file_name, workload &result) {
+    std::ifstream input_file(file_name);
+    if(!input_file.is_open()) {
+        return false;
+    }
+    std::string line;
+    while(std::getline(input_file, line)) {
+        if(!line.empty()) {
+            auto input_tokens = split_delim(line, ", ");
+            result.processes.push_back(add_process(input_tokens));
+            if(input_tokens.size() > 6) {
+                result.bursts[result.processes.back().PID] = input_tokens[6];
+            }
+        }
+    }
+    result.name = std::filesystem::path(file_name).filename().string();
+    return true;
+}
+
+//Random workload, sizes go slightly past the largest partition so some processes are never admitted
+workload random_workload(std::mt19937 &random, unsigned int number) {
+    auto draw = [&](unsigned int low, unsigned int high) {
+        return std::uniform_int_distribution<unsigned int>(low, high)(random);
+    };
+    auto chance = [&](unsigned int percent) {
+        return draw(1, 100) <= percent;
+    };
+
+    workload result;
+    result.name = "random_" + std::to_string(number);
+    unsigned int count = draw(1, 12);
+    for(unsigned int i = 0; i < count; i++) {
+        PCB process = add_process({std::to_string(i + 1), std::to_string(draw(1, 42)), std::to_string(draw(0, 400)),
+                                    std::to_string(draw(1, 500)), std::to_string(chance(25) ? 0 : draw(1, 120)),
+                                    std::to_string(draw(1, 90))});
+        result.processes.push_back(process);
+
+        // Some processes have varying bursts instead of a fixed I/O frequency and duration
+        if(chance(20)) {
+            std::string bursts;
+            for(unsigned int burst = draw(0, 5); burst > 0; burst--) {
+                bursts += std::to_string(draw(1, 80)) + "/" + std::to_string(draw(1, 60)) + " ";
+            }
+            result.bursts[process.PID] = bursts + std::to_string(draw(1, 80));
+        }
+    }
+
+    if(chance(50)) {
+        result.options.push_back({"--quantum", std::to_string(draw(1, 200))});
+    }
+    if(chance(15)) {
+        result.options.push_back({"--adaptive-quantum", ""});
+    }
+    if(chance(30)) {
+        result.options.push_back({"--context-switch", std::to_string(draw(1, 3))});
+    }
+    if(chance(20)) {
+        result.options.push_back({"--scheduler-cost", std::to_string(draw(1, 2))});
+    }
+    if(chance(10)) {
+        result.options.push_back({"--scheduler-cost-per-ready", "0.5"});
+    }
+    if(chance(20)) {
+        result.options.push_back({"--admission-cost", std::to_string(draw(1, 3))});
+    }
+    if(chance(30)) {
+        result.options.push_back({"--io-devices", std::to_string(draw(1, 3))});
+        if(chance(50)) {
+            result.options.push_back({"--io-queue", "priority"});
+        }
+    }
+    return result;
+}
+
+//Workload as a scheduler runs it, EP refuses the quantum options
+workload for_policy(workload current, const std::string &policy) {
+    if(policy == "EP") {
+        auto quantum = std::remove_if(current.options.begin(), current.options.end(), [](const run_option &option) {
+            return option.first == "--quantum" || option.first == "--adaptive-quantum";
+        });
+        current.options.erase(quantum, current.options.end());
+    }
+    return current;
+}
+
+//------------------------------------COMPARISON---------------------------------------------
+
+std::string read_text(const std::string &file_name) {
+    std::ifstream file(file_name, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+std::string print_record(const trace_record &record) {
+    std::stringstream buffer;
+    buffer << record.time << "ms PID " << record.PID << " " << record.old_state << " -> " << record.new_state;
+    return buffer.str();
+}
+
+//Compares two binary traces record by record, returns the first difference (empty if none)
+std::string compare_traces(const std::string &reference_file, const std::string &table_file) {
+    binary_trace_reader reference, table;
+    trace_header reference_header, table_header;
+    if(!reference.open(reference_file, reference_header) || !table.open(table_file, table_header)) {
+        return "a trace is missing or damaged";
+    }
+
+    trace_record expected, actual;
+    for(std::size_t event = 0; ; event++) {
+        bool has_expected = reference.next(expected);
+        bool has_actual = table.next(actual);
+        if(!has_expected && !has_actual) {
+            return "";
+        }
+        if(!has_expected || !has_actual) {
+            return "event " + std::to_string(event) + ": reference " + (has_expected ? print_record(expected) : "ends")
+                 + ", soa " + (has_actual ? print_record(actual) : "ends");
+        }
+        if(expected.time != actual.time || expected.PID != actual.PID
+           || expected.old_state != actual.old_state || expected.new_state != actual.new_state) {
+            return "event " + std::to_string(event) + ": reference " + print_record(expected) + ", soa " + print_record(actual);
+        }
+    }
+}
+
+//Compares the printed metrics, returns the first differing line (empty if none)
+std::string compare_reports(const std::string &reference, const std::string &table) {
+    std::stringstream expected(reference), actual(table);
+    std::string expected_line, actual_line;
+    while(true) {
+        bool has_expected = (bool) std::getline(expected, expected_line);
+        bool has_actual = (bool) std::getline(actual, actual_line);
+        if(!has_expected && !has_actual) {
+            return "";
+        }
+        if(!has_expected || !has_actual || expected_line != actual_line) {
+            return "output: reference \"" + (has_expected ? expected_line : "") + "\", soa \"" + (has_actual ? actual_line : "") + "\"";
+        }
+    }
+}
+
+//Runs one scheduler with both engines in directory, returns the first difference (empty if none)
+std::string run_both_engines(const std::string &binaries, const std::string &directory, const std::string &policy,
+                             const workload &current) {
+    std::string input_file = directory + "/input.txt";
+    std::ofstream(input_file, std::ios::trunc) << print_workload(current);
+
+    for(std::string engine : {"reference", "soa"}) {
+        std::string command = "cd \"" + directory + "\" && \"" + binaries + "/interrupts_" + policy + "\" input.txt"
+                            + print_options(current.options) + " --engine " + engine + " --no-text-trace --binary-trace "
+                            + engine + ".trace > " + engine + ".out 2> /dev/null";
+        if(std::system(command.c_str()) != 0) {
+            return engine + " run failed";
+        }
+    }
+
+    std::string difference = compare_traces(directory + "/reference.trace", directory + "/soa.trace");
+    if(difference.empty()) {
+        difference = compare_reports(read_text(directory + "/reference.out"), read_text(directory + "/soa.out"));
+    }
+    return difference;
+}
+
+//------------------------------------SHRINKING----------------------------------------------
+
+//Greedily removes processes and options and halves values while the engines still disagree
+workload shrink(const std::string &binaries, const std::string &directory, const std::string &policy, workload failing) {
+    auto fails = [&](const workload &candidate) {
+        return !candidate.processes.empty() && !run_both_engines(binaries, directory, policy, candidate).empty();
+    };
+
+    bool progress = true;
+    while(progress) {
+        progress = false;
+
+        for(std::size_t i = 0; i < failing.processes.size(); i++) {
+            workload candidate = failing;
+            candidate.processes.erase(candidate.processes.begin() + i);
+            if(fails(candidate)) {
+                failing = candidate;
+                progress = true;
+                i--;
+            }
+        }
+
+        for(auto bursts = failing.bursts.begin(); bursts != failing.bursts.end(); ) {
+            workload candidate = failing;
+            candidate.bursts.erase(bursts->first);
+            if(fails(candidate)) {
+                bursts = failing.bursts.erase(bursts);
+                progress = true;
+            } else {
+                bursts++;
+            }
+        }
+
+        for(std::size_t i = 0; i < failing.options.size(); i++) {
+            workload candidate = failing;
+            candidate.options.erase(candidate.options.begin() + i);
+            if(fails(candidate)) {
+                failing = candidate;
+                progress = true;
+                i--;
+            }
+        }
+
+        // Smaller values, a processing time of at least 1 and a size of at least 1
+        for(std::size_t i = 0; i < failing.processes.size(); i++) {
+            unsigned int PCB::*fields[] = {&PCB::arrival_time, &PCB::processing_time, &PCB::io_freq, &PCB::io_duration, &PCB::size};
+            for(auto field : fields) {
+                unsigned int lowest = (field == &PCB::processing_time || field == &PCB::size) ? 1 : 0;
+                while(failing.processes[i].*field > lowest) {
+                    workload candidate = failing;
+                    PCB &process = candidate.processes[i];
+                    process.*field = std::max(lowest, process.*field / 2);
+                    process.remaining_time = process.processing_time;
+                    process.priority = process.size;
+                    if(!fails(candidate)) {
+                        break;
+                    }
+                    failing = candidate;
+                    progress = true;
+                }
+            }
+        }
+    }
+    return failing;
+}
+
+//------------------------------------DRIVER-------------------------------------------------
+
+int main(int argc, char** argv) {
+
+    unsigned int runs = 1000;
+    unsigned int seed = 1;
+    unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string inputs = "input_files";
+    std::string program = argv[0];
+    std::string binaries = program.substr(0, program.find_last_of('/') + 1);
+    binaries = binaries.empty() ? "." : binaries.substr(0, binaries.size() - 1);
+
+    for(int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if(option == "--runs" && has_value) {
+            runs = std::atoi(argv[++i]);
+        } else if(option == "--seed" && has_value) {
+            seed = std::atoi(argv[++i]);
+        } else if(option == "--jobs" && has_value) {
+            jobs = std::max(1, std::atoi(argv[++i]));
+        } else if(option == "--inputs" && has_value) {
+            inputs = argv[++i];
+        } else if(option == "--bin" && has_value) {
+            binaries = argv[++i];
+        } else {
+            std::cout << "To run the program, do: ./engine_diff [--runs <n>] [--seed <n>] [--jobs <n>] "
+                      << "[--inputs <dir>] [--bin <dir>]" << std::endl;
+            return -1;
+        }
+    }
+    binaries = std::filesystem::absolute(binaries).string();
+
+    // Checked-in inputs first (with the default options), then the random workloads
+    std::vector<workload> workloads;
+    std::error_code error;
+    std::vector<std::string> input_files;
+    for(const auto &entry : std::filesystem::directory_iterator(inputs, error)) {
+        if(entry.path().extension() == ".txt") {
+            input_files.push_back(entry.path().string());
+        }
+    }
+    std::sort(input_files.begin(), input_files.end());
+    for(const auto &file_name : input_files) {
+        workload checked_in;
+        if(read_workload(file_name, checked_in)) {
+            workloads.push_back(checked_in);
+        }
+    }
+    std::mt19937 random(seed);
+    for(unsigned int i = 0; i < runs; i++) {
+        workloads.push_back(random_workload(random, i));
+    }
+
+    std::cout << "Comparing --engine reference and --engine soa on " << workloads.size() << " workloads ("
+              << input_files.size() << " checked in, " << runs << " random, seed " << seed << ")" << std::endl;
+
+    // Every (workload, scheduler) pair is a job, workers take them in order
+    std::size_t total = workloads.size() * std::size(POLICIES);
+    std::atomic<std::size_t> next_job{0};
+    std::atomic<unsigned int> failures{0};
+    std::mutex report;
+
+    auto worker = [&](unsigned int number) {
+        std::string directory = (std::filesystem::temp_directory_path()
+                              / ("engine_diff_" + std::to_string(getpid()) + "_" + std::to_string(number))).string();
+        std::filesystem::create_directories(directory);
+
+        for(std::size_t job = next_job++; job < total; job = next_job++) {
+            std::string policy = POLICIES[job % std::size(POLICIES)];
+            workload current = for_policy(workloads[job / std::size(POLICIES)], policy);
+
+            std::string difference = run_both_engines(binaries, directory, policy, current);
+            if(difference.empty()) {
+                continue;
+            }
+
+            workload minimal = shrink(binaries, directory, policy, current);
+            std::string minimal_difference = run_both_engines(binaries, directory, policy, minimal);
+            std::string failure_file = "engine_diff_" + policy + "_" + current.name + ".txt";
+            std::ofstream(failure_file, std::ios::trunc) << print_workload(minimal);
+
+            std::lock_guard<std::mutex> lock(report);
+            failures++;
+            std::cout << "MISMATCH " << policy << " " << current.name << print_options(current.options) << std::endl
+                      << "  " << difference << std::endl
+                      << "  shrunk to " << minimal.processes.size() << " processes in " << failure_file << ":" << std::endl
+                      << "  ./bin/interrupts_" << policy << " " << failure_file << print_options(minimal.options) << std::endl
+                      << "  " << minimal_difference << std::endl;
+        }
+        std::filesystem::remove_all(directory, error);
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int i = 0; i < jobs; i++) {
+        threads.emplace_back(worker, i);
+    }
+    for(auto &thread : threads) {
+        thread.join();
+    }
+
+    std::cout << total << " runs compared, " << failures << " mismatches" << std::endl;
+    return (failures == 0) ? 0 : 1;
+}
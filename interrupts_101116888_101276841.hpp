@@ -18,6 +18,16 @@
 #include<sstream>
 #include<iomanip>
 #include<algorithm>
+#include<map>
+#include<cmath>
+#include<thread>
+#include<cstdlib>
+#include<cstdint>
+#include<memory>
+#include<iterator>
+#include<climits>
+#include<cctype>
+#include<cerrno>
 
 //An enumeration of states to make assignment easier
 enum states {
@@ -26,7 +36,8 @@ enum states {
     RUNNING,
     WAITING,
     TERMINATED,
-    NOT_ASSIGNED
+    NOT_ASSIGNED,
+    SUSPENDED       // Swapped out of memory by the medium-term scheduler
 };
 std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading the << operator to make printing of the enum easier
 
@@ -36,22 +47,32 @@ std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading
                                 "RUNNING",
                                 "WAITING",
                                 "TERMINATED",
-                                "NOT_ASSIGNED"
+                                "NOT_ASSIGNED",
+                                "SUSPENDED"
     };
     return (os << state_names[s]);
 }
 
+//Partition table is per thread so that independent simulations (e.g. quantum tuning) can run in parallel
 struct memory_partition{
     unsigned int    partition_number;
     unsigned int    size;
     int             occupied;
-} memory_paritions[] = {
-    {1, 40, -1},
-    {2, 25, -1},
-    {3, 15, -1},
-    {4, 10, -1},
-    {5, 8, -1},
-    {6, 2, -1}
+    unsigned int    used;       // Size of the process holding the partition
+};
+thread_local memory_partition memory_paritions[] = {
+    {1, 40, -1, 0},
+    {2, 25, -1, 0},
+    {3, 15, -1, 0},
+    {4, 10, -1, 0},
+    {5, 8, -1, 0},
+    {6, 2, -1, 0}
+};
+
+//I/O requests of a process whose CPU bursts vary (e.g. imported from a scheduler trace)
+struct burst_schedule {
+    std::vector<unsigned int>   io_points;      // CPU time after which each I/O is requested (ascending)
+    std::vector<unsigned int>   io_lengths;     // Duration of each I/O
 };
 
 struct PCB{
@@ -67,6 +88,7 @@ struct PCB{
     unsigned int    io_duration;
     unsigned int    priority;        // Lower number = higher priority (for External Priorities)
     unsigned int    time_in_cpu;     // Track time spent in CPU for RR
+    std::shared_ptr<const burst_schedule> bursts;   // Varying bursts, null = I/O every io_freq ms
 };
 
 //------------------------------------HELPER FUNCTIONS FOR THE SIMULATOR------------------------------
@@ -85,6 +107,47 @@ std::vector<std::string> split_delim(std::string input, std::string delim) {
     return tokens;
 }
 
+//Parses a whole decimal number that fits an unsigned int, returns false for anything else ("abc", "5x", "-1")
+bool parse_unsigned(const std::string &text, unsigned int &value) {
+    if(text.empty() || !std::isdigit((unsigned char) text[0])) {
+        return false;   // strtoul would accept a sign or leading spaces
+    }
+    errno = 0;
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(text.c_str(), &end, 10);
+    if(*end != '\0' || errno == ERANGE || parsed > UINT_MAX) {
+        return false;
+    }
+    value = (unsigned int) parsed;
+    return true;
+}
+
+//Parses a non-negative decimal number ("0.5", "2")
+bool parse_decimal(const std::string &text, double &value) {
+    if(text.empty() || !(std::isdigit((unsigned char) text[0]) || text[0] == '.')) {
+        return false;
+    }
+    char* end = nullptr;
+    double parsed = std::strtod(text.c_str(), &end);
+    if(*end != '\0' || !std::isfinite(parsed)) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+//Parses a comma separated list of PIDs ("3" or "1,4,7")
+bool parse_PIDs(const std::string &text, std::vector<int> &PIDs) {
+    for(const auto &item : split_delim(text, ",")) {
+        unsigned int PID = 0;
+        if(!parse_unsigned(item, PID) || PID > INT_MAX) {
+            return false;
+        }
+        PIDs.push_back((int) PID);
+    }
+    return true;
+}
+
 //Function that takes a queue as an input and outputs a string table of PCBs
 std::string print_PCB(std::vector<PCB> _PCB) {
     const int tableWidth = 83;
@@ -228,37 +291,135 @@ void write_output(std::string execution, const char* filename) {
 
 //--------------------------------------------FUNCTIONS FOR THE "OS"-------------------------------------
 
-//Assign memory partition to program
-bool assign_memory(PCB &program) {
-    int size_to_fit = program.size;
+//Logs the partition table after a change (defined with the simulation state below)
+void record_memory_status();
+
+//Assign a memory partition to process PID, returns the partition number or -1 if none fits
+int assign_partition(int PID, unsigned int size) {
+    int size_to_fit = size;
     int available_size = 0;
 
     for(int i = 5; i >= 0; i--) {
         available_size = memory_paritions[i].size;
 
         if(size_to_fit <= available_size && memory_paritions[i].occupied == -1) {
-            memory_paritions[i].occupied = program.PID;
-            program.partition_number = memory_paritions[i].partition_number;
-            return true;
+            memory_paritions[i].occupied = PID;
+            memory_paritions[i].used = size;
+            record_memory_status();
+            return memory_paritions[i].partition_number;
         }
     }
 
-    return false;
+    return -1;
 }
 
-//Free a memory partition
-bool free_memory(PCB &program){
+//Assign memory partition to program
+bool assign_memory(PCB &program) {
+    int partition = assign_partition(program.PID, program.size);
+    if(partition == -1) {
+        return false;
+    }
+    program.partition_number = partition;
+    return true;
+}
+
+//Mark every partition as free (start of a simulation run)
+void reset_memory() {
+    for(auto &partition : memory_paritions) {
+        partition.occupied = -1;
+        partition.used = 0;
+    }
+}
+
+//Free the memory partition held by process PID
+//PID -1 (the idle CPU) holds nothing, it must not match a free partition
+bool free_partition(int PID) {
+    if(PID == -1) {
+        return false;
+    }
     for(int i = 5; i >= 0; i--) {
-        if(program.PID == memory_paritions[i].occupied) {
+        if(PID == memory_paritions[i].occupied) {
             memory_paritions[i].occupied = -1;
-            program.partition_number = -1;
+            memory_paritions[i].used = 0;
+            record_memory_status();
             return true;
         }
     }
     return false;
 }
 
+//Free a memory partition
+bool free_memory(PCB &program){
+    if(!free_partition(program.PID)) {
+        return false;
+    }
+    program.partition_number = -1;
+    return true;
+}
+
+//Returns true if the process requests I/O once it has used cpu_time ms of CPU
+//Without a burst schedule it does so every io_freq ms of CPU
+bool io_due(const burst_schedule *schedule, unsigned int io_freq, unsigned int cpu_time) {
+    if(schedule != nullptr) {
+        return std::binary_search(schedule->io_points.begin(), schedule->io_points.end(), cpu_time);
+    }
+    return io_freq > 0 && cpu_time > 0 && cpu_time % io_freq == 0;
+}
+
+bool io_due(const PCB &process, unsigned int cpu_time) {
+    return io_due(process.bursts.get(), process.io_freq, cpu_time);
+}
+
+//Duration of the I/O requested after cpu_time ms of CPU
+unsigned int io_length(const burst_schedule *schedule, unsigned int io_duration, unsigned int cpu_time) {
+    if(schedule != nullptr) {
+        const auto &points = schedule->io_points;
+        auto point = std::lower_bound(points.begin(), points.end(), cpu_time);
+        if(point != points.end() && *point == cpu_time) {
+            return schedule->io_lengths[point - points.begin()];
+        }
+    }
+    return io_duration;
+}
+
+unsigned int io_length(const PCB &process, unsigned int cpu_time) {
+    return io_length(process.bursts.get(), process.io_duration, cpu_time);
+}
+
+//Parses the optional bursts field "cpu/io cpu/io ... cpu" of an input line into the schedule of the process.
+//The CPU time of the process becomes the sum of its bursts, io_freq and io_duration those of the first I/O.
+bool add_burst_schedule(PCB &process, const std::string &bursts) {
+    burst_schedule schedule;
+    unsigned int cpu_time = 0;
+    for(const auto &burst : split_delim(bursts, " ")) {
+        if(burst.empty()) {
+            continue;
+        }
+        auto parts = split_delim(burst, "/");
+        int length = std::stoi(parts[0]);
+        if(length <= 0 || parts.size() > 2) {
+            return false;
+        }
+        cpu_time += length;
+        if(parts.size() == 2) {
+            schedule.io_points.push_back(cpu_time);
+            schedule.io_lengths.push_back(std::stoi(parts[1]));
+        }
+    }
+    if(cpu_time == 0) {
+        return false;
+    }
+
+    process.processing_time = cpu_time;
+    process.remaining_time = cpu_time;
+    process.io_freq = schedule.io_points.empty() ? 0 : schedule.io_points[0];
+    process.io_duration = schedule.io_lengths.empty() ? 0 : schedule.io_lengths[0];
+    process.bursts = std::make_shared<const burst_schedule>(schedule);
+    return true;
+}
+
 //Convert a list of strings into a PCB
+//A seventh token, if present, holds the varying CPU bursts and I/O blocks of the process
 PCB add_process(std::vector<std::string> tokens) {
     PCB process;
     process.PID = std::stoi(tokens[0]);
@@ -273,10 +434,34 @@ PCB add_process(std::vector<std::string> tokens) {
     process.state = NOT_ASSIGNED;
     process.priority = process.size;  // Use size as priority (smaller processes = higher priority)
     process.time_in_cpu = 0;
+    if(tokens.size() > 6 && !add_burst_schedule(process, tokens[6])) {
+        throw std::invalid_argument("bursts");
+    }
 
     return process;
 }
 
+//Parses the processes of the input file, returns false (with an error naming the line) at the first bad line
+bool read_input_file(std::istream &input_file, std::vector<PCB> &list_process) {
+    std::string line;
+    while(std::getline(input_file, line)) {
+        if(line.empty()) {
+            continue;
+        }
+        auto input_tokens = split_delim(line, ", ");
+        try {
+            if(input_tokens.size() != 6 && input_tokens.size() != 7) {
+                throw std::invalid_argument("fields");
+            }
+            list_process.push_back(add_process(input_tokens));
+        } catch(const std::exception &) {
+            std::cerr << "Error: invalid process line: " << line << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 //Returns true if all processes in the queue have terminated
 bool all_process_terminated(std::vector<PCB> processes) {
 
@@ -317,6 +502,1307 @@ void idle_CPU(PCB &running) {
     running.size = 0;
     running.state = NOT_ASSIGNED;
     running.PID = -1;
+    running.bursts = nullptr;
+}
+
+//--------------------------------------------SIMULATION CONFIGURATION AND METRICS-------------------------
+
+//Policies for picking the process to swap out
+enum swap_policies {
+    LONGEST_BLOCKED,    // Blocked process that has been waiting for I/O the longest
+    LOWEST_PRIORITY     // Blocked or ready process with the lowest priority
+};
+
+//Objectives the quantum tuner can minimize
+enum objectives {
+    MEAN_TURNAROUND,
+    MEAN_RESPONSE,
+    P99_RESPONSE,
+    MEAN_WAIT
+};
+
+//Implementations of the simulation loop
+enum engines {
+    REFERENCE_ENGINE,   // PCBs copied between vector queues
+    TABLE_ENGINE        // Struct-of-arrays process table with handle queues
+};
+
+//Transition selected by --trace-transitions, -1 stands for any state
+struct transition_pattern {
+    int     old_state;
+    int     new_state;
+};
+
+//Which transitions reach the execution table and the trace sinks, the metrics always see all of them
+struct trace_filter {
+    std::vector<int>                    PIDs;           // Sorted, empty = every process
+    std::vector<transition_pattern>     transitions;    // Empty = every transition
+    unsigned int                        from_time = 0;
+    unsigned int                        until_time = UINT_MAX;  // Inclusive
+    unsigned int                        sample_every = 1;   // Keep 1 in N of the transitions passing the other filters
+    std::size_t                         keep_last = 0;      // Keep only the last K rows of the execution table, 0 = all
+};
+
+//Options shared by all schedulers, parsed from the command line
+struct sim_config {
+    unsigned int    time_quantum = 100;     // Quantum for the RR based schedulers (ms)
+    bool            adaptive_quantum = false; // Derive the quantum from the observed CPU bursts
+    bool            tune = false;           // Search the quantum space instead of a single run
+    enum objectives objective = MEAN_TURNAROUND;
+    unsigned int    tune_min = 5;           // Smallest quantum considered by the tuner
+    unsigned int    tune_max = 1000;        // Largest quantum considered by the tuner
+    unsigned int    context_switch_cost = 0;        // CPU time to switch to a newly dispatched process (ms)
+    unsigned int    scheduler_cost = 0;             // CPU time for each scheduling decision (ms)
+    double          scheduler_cost_per_ready = 0;   // Extra decision time per process in the ready queue (ms)
+    unsigned int    admission_cost = 0;             // CPU time to admit a process into memory (ms)
+    unsigned int    io_devices = 0;         // Number of I/O devices, 0 = every I/O runs in parallel
+    bool            io_priority_queue = false; // Serve device queues by priority instead of FIFO
+    bool            swapping = false;       // Swap processes out when no partition fits an arrival
+    enum swap_policies swap_policy = LONGEST_BLOCKED;
+    unsigned int    swap_cost = 1;          // Time to swap one MB in or out (ms)
+    std::string     policy;                 // Name of the scheduler running the simulation
+    std::string     checkpoint_file;        // Where to save checkpoints, empty = never
+    unsigned int    checkpoint_interval = 0; // Simulated time between checkpoints (ms)
+    std::string     resume_file;            // Checkpoint to resume from instead of the input file
+    std::string     fork_spec;              // Branches of a what-if fork, empty = no fork
+    unsigned int    fork_time = 0;          // When to fork the simulation (ms)
+    std::string     binary_trace_file;      // Where to write the binary trace, empty = none
+    bool            text_trace = true;      // Write the execution table
+    std::string     chrome_trace_file;      // Where to write the trace-event JSON timeline, empty = none
+    bool            memory_status = false;  // Log the partition table on every allocation and release
+    unsigned int    memory_interval = 0;    // Minimum time between two logged rows (ms), 0 = every change
+    enum engines    engine = REFERENCE_ENGINE;
+    bool            pipeline = false;       // Write the execution table on a separate thread
+    bool            daemon = false;         // Serve commands instead of running the input file to the end
+    std::string     socket_path;            // UNIX socket of the service, empty = stdin/stdout
+    unsigned int    snapshot_every = 4096;  // Trace records between two snapshots of the trace index
+    trace_filter    filter;                 // Recording controls of the execution table and the trace sinks
+    unsigned int    replicas = 0;           // Monte Carlo replicas of the workload, 0 = a single deterministic run
+    unsigned int    seed = 1;               // Base seed of the Monte Carlo replicas
+    std::string     import_format;          // Scheduler trace format of the input file (perf, proc), empty = input format
+    unsigned int    import_tick_us = 1000;  // Microseconds of the imported trace per simulated ms
+    unsigned int    import_size = 1;        // Memory size of the imported tasks
+};
+
+//Per process bookkeeping used to compute the metrics
+struct process_stats {
+    bool            arrived = false;        // Arrival recorded before admission (memory was full)
+    unsigned int    arrival = 0;
+    int             first_run = -1;
+    int             completion = -1;
+    unsigned int    ready_since = 0;
+    unsigned int    wait_time = 0;          // Total time spent in the ready queue
+    unsigned int    burst_start = 0;        // When the process was last dispatched
+    unsigned int    burst_length = 0;       // CPU time accumulated in the current burst
+    unsigned int    io_since = 0;           // When the current I/O was requested
+};
+
+//Usage statistics of one I/O device
+struct io_device_stats {
+    unsigned int                            busy_time = 0;
+    unsigned int                            requests = 0;
+    std::map<unsigned int, unsigned int>    queue_histogram;    // Queue length -> ms spent at that length
+};
+
+//Metrics collected from the stream of state transitions
+struct sim_metrics {
+    std::map<int, process_stats>    processes;
+    std::vector<unsigned int>       recent_bursts;  // Sliding window of completed CPU bursts
+    unsigned int                    last_event = 0;
+    unsigned int                    useful_time = 0;    // CPU time spent executing processes
+    unsigned int                    overhead_time = 0;  // CPU time lost to switching, scheduling and admission
+    unsigned int                    io_operations = 0;
+    unsigned int                    io_wait_time = 0;   // Total time spent waiting for I/O, queueing included
+    std::vector<io_device_stats>    io_devices;
+    unsigned int                    swap_outs = 0;
+    unsigned int                    swap_ins = 0;
+    unsigned int                    swap_traffic = 0;   // MB moved between memory and the swap area
+};
+
+//One state transition
+struct trace_record {
+    unsigned int    time;
+    int             PID;
+    enum states     old_state;
+    enum states     new_state;
+};
+
+struct sim_state;
+struct table_state;
+
+//Receives every transition besides the execution table (binary trace, timeline export, ...)
+struct transition_sink {
+    virtual ~transition_sink() {}
+    virtual void record(unsigned int current_time, int PID, states old_state, states new_state) = 0;
+
+    //Partition table changed (allocation or release), called whatever the filters
+    virtual void record_memory(unsigned int /*current_time*/) {}
+
+    //A ms is over, with the state of the engine that ran it (reference or table engine)
+    virtual void tick_done(const sim_state & /*state*/) {}
+    virtual void tick_done(const table_state & /*state*/) {}
+};
+
+//Everything the simulation produces while it runs
+struct sim_recorder {
+    bool            text_trace = true;      // Build the execution table
+    std::vector<std::shared_ptr<transition_sink>> sinks;
+    trace_filter    filter;
+    std::uint64_t   transitions = 0;        // Transitions of the run
+    std::uint64_t   matched = 0;            // Transitions that passed the filters, before sampling
+    std::uint64_t   recorded = 0;           // Transitions passed to the table and the sinks
+    std::vector<trace_record> last_rows;    // Ring of the last rows of the execution table (keep_last mode)
+    std::size_t     next_row = 0;           // Oldest row of the ring once it is full
+    std::string     execution_status;
+    sim_metrics     metrics;
+    std::string     output_file;            // Set when the execution table is streamed to a file
+    std::uint64_t   output_position = 0;    // Bytes of the execution table already in output_file
+    bool            memory_tracking = false;
+    unsigned int    memory_interval = 0;
+    std::string     memory_status;          // Memory status table
+    std::string     memory_file;            // Set when the memory status table is streamed to a file
+    std::uint64_t   memory_position = 0;    // Bytes of the memory status table already in memory_file
+    std::string     pending_memory_row;     // Latest row held back by the downsampling
+    unsigned int    next_memory_sample = 0; // End of the interval of the pending row
+};
+
+const std::size_t BURST_WINDOW = 64;
+
+//Counts a finished I/O operation, its wait runs from the I/O start (a swap-out during the I/O does not end it)
+void observe_io_completion(sim_metrics &metrics, unsigned int current_time, int PID) {
+    metrics.io_operations++;
+    metrics.io_wait_time += current_time - metrics.processes[PID].io_since;
+}
+
+//Update the metrics with a state transition
+void observe_transition(sim_metrics &metrics, unsigned int current_time, int PID, states old_state, states new_state) {
+    // EP reports the idle CPU (PID -1) as terminated after an I/O request, it is not a process
+    if(PID < 0) {
+        return;
+    }
+    process_stats &stats = metrics.processes[PID];
+    metrics.last_event = current_time;
+
+    if(old_state == NEW && !stats.arrived) {
+        stats.arrival = current_time;
+    }
+    if(old_state == READY) {
+        stats.wait_time += current_time - stats.ready_since;
+    }
+    if(new_state == READY) {
+        stats.ready_since = current_time;
+    }
+
+    if(new_state == RUNNING) {
+        if(stats.first_run == -1) {
+            stats.first_run = current_time;
+        }
+        stats.burst_start = current_time;
+    }
+
+    if(old_state == RUNNING) {
+        stats.burst_length += current_time - stats.burst_start;
+
+        // A CPU burst ends on I/O or termination, preemption only pauses it
+        if(new_state != READY) {
+            metrics.recent_bursts.push_back(stats.burst_length);
+            if(metrics.recent_bursts.size() > BURST_WINDOW) {
+                metrics.recent_bursts.erase(metrics.recent_bursts.begin());
+            }
+            stats.burst_length = 0;
+        }
+    }
+
+    if(new_state == WAITING) {
+        stats.io_since = current_time;
+    }
+    // A process swapped out during its I/O keeps waiting, see observe_io_completion
+    if(old_state == WAITING && new_state != SUSPENDED) {
+        observe_io_completion(metrics, current_time, PID);
+    }
+
+    if(new_state == TERMINATED) {
+        stats.completion = current_time;
+    }
+}
+
+//Returns true if any recording control is set
+bool filtering(const trace_filter &filter) {
+    return !filter.PIDs.empty() || !filter.transitions.empty() || filter.from_time > 0
+        || filter.until_time != UINT_MAX || filter.sample_every > 1;
+}
+
+//Returns true if the transition passes the filters and the sampling
+bool trace_selected(sim_recorder &recorder, unsigned int current_time, int PID, states old_state, states new_state) {
+    const trace_filter &filter = recorder.filter;
+    if(current_time < filter.from_time || current_time > filter.until_time) {
+        return false;
+    }
+    if(!filter.PIDs.empty() && !std::binary_search(filter.PIDs.begin(), filter.PIDs.end(), PID)) {
+        return false;
+    }
+    if(!filter.transitions.empty()) {
+        auto matches = [&](const transition_pattern &pattern) {
+            return (pattern.old_state == -1 || pattern.old_state == old_state)
+                && (pattern.new_state == -1 || pattern.new_state == new_state);
+        };
+        if(std::none_of(filter.transitions.begin(), filter.transitions.end(), matches)) {
+            return false;
+        }
+    }
+    return recorder.matched++ % filter.sample_every == 0;
+}
+
+//Adds a row to the ring of the last rows, overwriting the oldest once it is full
+void keep_row(sim_recorder &recorder, const trace_record &row) {
+    if(recorder.last_rows.size() < recorder.filter.keep_last) {
+        recorder.last_rows.push_back(row);
+        return;
+    }
+    recorder.last_rows[recorder.next_row] = row;
+    recorder.next_row = (recorder.next_row + 1) % recorder.last_rows.size();
+}
+
+//Records a transition in the execution table and the metrics
+void record_transition(sim_recorder &recorder, unsigned int current_time, int PID, states old_state, states new_state) {
+    recorder.transitions++;
+    if(trace_selected(recorder, current_time, PID, old_state, new_state)) {
+        recorder.recorded++;
+        if(recorder.text_trace && recorder.filter.keep_last > 0) {
+            keep_row(recorder, {current_time, PID, old_state, new_state});
+        } else if(recorder.text_trace) {
+            recorder.execution_status += print_exec_status(current_time, PID, old_state, new_state);
+        }
+        for(auto &sink : recorder.sinks) {
+            sink->record(current_time, PID, old_state, new_state);
+        }
+    }
+    observe_transition(recorder.metrics, current_time, PID, old_state, new_state);
+}
+
+//Appends the rows kept by the ring (oldest first) and the bottom border to the execution table
+void close_execution_table(sim_recorder &recorder) {
+    std::size_t count = recorder.last_rows.size();
+    for(std::size_t i = 0; i < count; i++) {
+        const trace_record &row = recorder.last_rows[(recorder.next_row + i) % count];
+        recorder.execution_status += print_exec_status(row.time, row.PID, row.old_state, row.new_state);
+    }
+    recorder.last_rows.clear();
+    recorder.next_row = 0;
+    recorder.execution_status += print_exec_footer();
+}
+
+//One line summary of the recording controls, empty if the whole run was recorded
+std::string print_trace_summary(const sim_recorder &recorder) {
+    if(!filtering(recorder.filter) && recorder.filter.keep_last == 0) {
+        return "";
+    }
+    std::stringstream buffer;
+    buffer << "Recorded transitions:   " << recorder.recorded << " of " << recorder.transitions;
+    if(recorder.filter.keep_last > 0) {
+        buffer << " (execution table keeps the last " << recorder.filter.keep_last << ")";
+    }
+    buffer << std::endl;
+    return buffer.str();
+}
+
+//CPU time the OS spends dispatching a process from a ready queue of the given size
+unsigned int dispatch_cost(const sim_config &config, std::size_t ready_size) {
+    return config.context_switch_cost + config.scheduler_cost
+         + (unsigned int) std::lround(config.scheduler_cost_per_ready * ready_size);
+}
+
+//Spends the current ms of CPU on pending OS overhead, returns false if there is none
+bool spend_overhead(unsigned int &overhead_pending, sim_metrics &metrics) {
+    if(overhead_pending == 0) {
+        return false;
+    }
+    overhead_pending--;
+    metrics.overhead_time++;
+    return true;
+}
+
+//--------------------------------------------I/O DEVICES------------------------------------------------
+
+struct io_request {
+    int             PID;
+    unsigned int    duration;
+    unsigned int    priority;
+    unsigned int    submitted;
+};
+
+//A device serves one request at a time, the others wait in its queue
+struct io_device {
+    int                     PID = -1;           // Request in service, -1 if idle
+    unsigned int            finish_time = 0;
+    std::vector<io_request> queue;
+};
+
+struct io_subsystem {
+    std::vector<io_device>  devices;            // Empty = unlimited parallel I/O
+    bool                    priority_queue = false;
+    std::vector<int>        completed;          // PIDs whose I/O finished this ms
+};
+
+void init_io(io_subsystem &io, const sim_config &config, sim_metrics &metrics) {
+    io.devices.assign(config.io_devices, io_device());
+    io.priority_queue = config.io_priority_queue;
+    io.completed.clear();
+    metrics.io_devices.assign(config.io_devices, io_device_stats());
+}
+
+//Queues an I/O request on the device with the shortest queue
+void submit_io(io_subsystem &io, int PID, unsigned int io_duration, unsigned int priority, unsigned int current_time) {
+    if(io.devices.empty()) {
+        return;
+    }
+
+    std::size_t chosen = 0;
+    std::size_t shortest = 0;
+    for(std::size_t i = 0; i < io.devices.size(); i++) {
+        std::size_t length = io.devices[i].queue.size() + (io.devices[i].PID != -1 ? 1 : 0);
+        if(i == 0 || length < shortest) {
+            chosen = i;
+            shortest = length;
+        }
+    }
+    io.devices[chosen].queue.push_back({PID, io_duration, priority, current_time});
+}
+
+void submit_io(io_subsystem &io, const PCB &process, unsigned int current_time) {
+    submit_io(io, process.PID, io_length(process, process.processing_time - process.remaining_time),
+              process.priority, current_time);
+}
+
+//Completes finished requests and starts queued ones, then samples the queue lengths
+void advance_io(io_subsystem &io, unsigned int current_time, sim_metrics &metrics) {
+    io.completed.clear();
+
+    for(std::size_t i = 0; i < io.devices.size(); i++) {
+        io_device &device = io.devices[i];
+        io_device_stats &stats = metrics.io_devices[i];
+
+        while(true) {
+            if(device.PID != -1) {
+                if(device.finish_time > current_time) {
+                    break;
+                }
+                io.completed.push_back(device.PID);
+                device.PID = -1;
+            }
+            if(device.queue.empty()) {
+                break;
+            }
+
+            // Next request: oldest one, or the highest priority one (FIFO among equals)
+            auto next = device.queue.begin();
+            if(io.priority_queue) {
+                for(auto it = device.queue.begin(); it != device.queue.end(); it++) {
+                    if(it->priority < next->priority) {
+                        next = it;
+                    }
+                }
+            }
+
+            // The device has been free since the later of its last completion and the request
+            unsigned int start = std::max(next->submitted, device.finish_time);
+            device.PID = next->PID;
+            device.finish_time = start + next->duration;
+            stats.busy_time += next->duration;
+            stats.requests++;
+            device.queue.erase(next);
+        }
+
+        stats.queue_histogram[device.queue.size()]++;
+    }
+}
+
+//Returns true if the I/O of the process is over
+//Without devices the I/O simply lasts io_duration from the time it was requested
+bool io_finished(io_subsystem &io, int PID, unsigned int io_duration, unsigned int wait_time) {
+    if(io.devices.empty()) {
+        return wait_time >= io_duration;
+    }
+
+    auto done = std::find(io.completed.begin(), io.completed.end(), PID);
+    if(done == io.completed.end()) {
+        return false;
+    }
+    io.completed.erase(done);
+    return true;
+}
+
+bool io_finished(io_subsystem &io, const PCB &process, unsigned int wait_time) {
+    return io_finished(io, process.PID, io_length(process, process.processing_time - process.remaining_time),
+                       wait_time);
+}
+
+std::string print_io_report(const sim_metrics &metrics) {
+    std::stringstream buffer;
+
+    if(metrics.io_operations > 0) {
+        buffer << std::fixed << std::setprecision(2)
+               << "Mean I/O wait:          " << (double) metrics.io_wait_time / metrics.io_operations
+               << " ms over " << metrics.io_operations << " operations" << std::endl;
+    }
+
+    for(std::size_t i = 0; i < metrics.io_devices.size(); i++) {
+        const io_device_stats &stats = metrics.io_devices[i];
+        double utilization = 0;
+        if(metrics.last_event > 0) {
+            utilization = std::min(100.0, 100.0 * stats.busy_time / metrics.last_event);
+        }
+        buffer << "I/O device " << i + 1 << ": " << stats.requests << " requests, "
+               << std::fixed << std::setprecision(2) << utilization << "% utilization" << std::endl;
+        buffer << "    Queue length histogram (length: ms):";
+        for(const auto &bucket : stats.queue_histogram) {
+            buffer << " " << bucket.first << ": " << bucket.second;
+        }
+        buffer << std::endl;
+    }
+
+    return buffer.str();
+}
+
+//--------------------------------------------MEDIUM-TERM SCHEDULER--------------------------------------
+
+//A process being loaded into memory, it becomes READY once the transfer is over
+struct swap_transfer {
+    PCB             process;
+    unsigned int    ready_time;
+    enum states     old_state;      // NEW for an admission, SUSPENDED for a swap-in
+};
+
+struct swap_state {
+    std::vector<PCB>            admission_queue;    // Arrivals waiting for a partition
+    std::vector<PCB>            suspended;          // Swapped out processes ready to come back
+    std::vector<swap_transfer>  loading;
+};
+
+unsigned int partition_size(int partition_number) {
+    for(const auto &partition : memory_paritions) {
+        if((int) partition.partition_number == partition_number) {
+            return partition.size;
+        }
+    }
+    return 0;
+}
+
+unsigned int largest_partition() {
+    unsigned int largest = 0;
+    for(const auto &partition : memory_paritions) {
+        largest = std::max(largest, partition.size);
+    }
+    return largest;
+}
+
+//Keeps an arrival that did not get a partition until memory can be freed for it
+void queue_admission(swap_state &swap, PCB &process, std::vector<PCB> &job_list, sim_metrics &metrics, unsigned int current_time) {
+    if(process.size > largest_partition()) {
+        return;     // Can never fit, same as without swapping
+    }
+    process.state = NEW;
+    swap.admission_queue.push_back(process);
+    job_list.push_back(process);
+
+    process_stats &stats = metrics.processes[process.PID];
+    stats.arrived = true;
+    stats.arrival = current_time;
+}
+
+//Picks a resident process whose partition can hold a process of the given size
+//Returns the PID of the victim or -1 if there is none
+int pick_swap_victim(const sim_config &config, const sim_metrics &metrics, unsigned int size,
+                     const std::vector<PCB> &ready_queue, const std::vector<PCB> &wait_queue) {
+    int victim = -1;
+    unsigned int victim_priority = 0;
+    unsigned int victim_since = 0;
+
+    auto consider = [&](const PCB &process, unsigned int since) {
+        if(partition_size(process.partition_number) < size) {
+            return;
+        }
+        bool better;
+        if(config.swap_policy == LOWEST_PRIORITY) {
+            better = (victim == -1 || process.priority > victim_priority
+                      || (process.priority == victim_priority && since < victim_since));
+        } else {
+            better = (victim == -1 || since < victim_since);
+        }
+        if(better) {
+            victim = process.PID;
+            victim_priority = process.priority;
+            victim_since = since;
+        }
+    };
+
+    for(const auto &process : wait_queue) {
+        if(process.state == WAITING) {
+            consider(process, metrics.processes.at(process.PID).io_since);
+        }
+    }
+    if(config.swap_policy == LOWEST_PRIORITY) {
+        for(const auto &process : ready_queue) {
+            consider(process, metrics.processes.at(process.PID).ready_since);
+        }
+    }
+
+    return victim;
+}
+
+//Swaps a process out, freeing its partition. Returns the size swapped out.
+unsigned int swap_out(swap_state &swap, int PID, std::vector<PCB> &ready_queue, std::vector<PCB> &wait_queue,
+                      std::vector<PCB> &job_list, sim_recorder &recorder, unsigned int current_time) {
+    for(auto &process : wait_queue) {
+        if(process.PID == PID) {
+            // Its I/O carries on, it moves to the suspended list once the I/O is over
+            unsigned int size = process.size;
+            free_memory(process);
+            process.state = SUSPENDED;
+            sync_queue(job_list, process);
+            record_transition(recorder, current_time, PID, WAITING, SUSPENDED);
+            return size;
+        }
+    }
+    for(auto it = ready_queue.begin(); it != ready_queue.end(); it++) {
+        if(it->PID == PID) {
+            PCB process = *it;
+            ready_queue.erase(it);
+            free_memory(process);
+            process.state = SUSPENDED;
+            swap.suspended.push_back(process);
+            sync_queue(job_list, process);
+            record_transition(recorder, current_time, PID, READY, SUSPENDED);
+            return process.size;
+        }
+    }
+    return 0;
+}
+
+//Runs the medium-term scheduler for the current ms: finishes transfers, swaps suspended
+//processes back in, then admits waiting arrivals, swapping out a victim when memory is full.
+//The transfer time replaces the admission cost for processes admitted here.
+//Returns true if a process became READY.
+bool medium_term_schedule(swap_state &swap, const sim_config &config, std::vector<PCB> &ready_queue,
+                          std::vector<PCB> &wait_queue, std::vector<PCB> &job_list,
+                          sim_recorder &recorder, unsigned int current_time) {
+    if(!config.swapping) {
+        return false;
+    }
+    sim_metrics &metrics = recorder.metrics;
+
+    // Swap-ins come first so that suspended processes are not starved by new arrivals
+    std::vector<PCB> still_suspended;
+    for(auto &process : swap.suspended) {
+        if(assign_memory(process)) {
+            swap.loading.push_back({process, current_time + process.size * config.swap_cost, SUSPENDED});
+            metrics.swap_ins++;
+            metrics.swap_traffic += process.size;
+        } else {
+            still_suspended.push_back(process);
+        }
+    }
+    swap.suspended = still_suspended;
+
+    std::vector<PCB> still_queued;
+    for(auto &process : swap.admission_queue) {
+        if(assign_memory(process)) {
+            swap.loading.push_back({process, current_time, NEW});
+            continue;
+        }
+
+        int victim = pick_swap_victim(config, metrics, process.size, ready_queue, wait_queue);
+        if(victim == -1) {
+            still_queued.push_back(process);
+            continue;
+        }
+
+        // The arrival can only be loaded once the victim has been written out
+        unsigned int swapped = swap_out(swap, victim, ready_queue, wait_queue, job_list, recorder, current_time);
+        metrics.swap_outs++;
+        metrics.swap_traffic += swapped;
+        assign_memory(process);
+        swap.loading.push_back({process, current_time + swapped * config.swap_cost, NEW});
+    }
+    swap.admission_queue = still_queued;
+
+    bool became_ready = false;
+    std::vector<swap_transfer> still_loading;
+    for(auto &transfer : swap.loading) {
+        if(transfer.ready_time > current_time) {
+            still_loading.push_back(transfer);
+            continue;
+        }
+        PCB &process = transfer.process;
+        process.state = READY;
+        process.time_in_cpu = 0;
+        ready_queue.push_back(process);
+        sync_queue(job_list, process);
+        record_transition(recorder, current_time, process.PID, transfer.old_state, READY);
+        became_ready = true;
+    }
+    swap.loading = still_loading;
+
+    return became_ready;
+}
+
+//--------------------------------------------SIMULATION STATE-------------------------------------------
+
+//Complete state of a running simulation, everything needed to continue it
+struct sim_state {
+    std::vector<PCB>    list_processes;     // Processes that have not arrived yet
+    std::vector<PCB>    ready_queue;        // Processes ready to run
+    std::vector<PCB>    wait_queue;         // Processes waiting for I/O completion
+    std::vector<PCB>    job_list;           // All processes for tracking
+    PCB                 running;
+    unsigned int        current_time = 0;
+    unsigned int        overhead_pending = 0;   // OS work the CPU must do before running processes
+    unsigned int        quantum_remaining = 0;  // Time left in current quantum
+    unsigned int        io_start_time = 0;      // Start of the last I/O (EP scheduler)
+    sim_recorder        recorder;
+    io_subsystem        io;                 // I/O devices (none = unlimited parallel I/O)
+    swap_state          swap;               // Medium-term scheduler queues (only used with swapping)
+};
+
+//Shows the state at the end of a ms to the sinks
+template<typename State>
+void finish_tick(const State &state) {
+    for(auto &sink : state.recorder.sinks) {
+        sink->tick_done(state);
+    }
+}
+
+//--------------------------------------------MEMORY STATUS----------------------------------------------
+
+//Recorder and clock of the simulation running on this thread, memory changes are logged into the recorder
+thread_local sim_recorder *active_recorder = nullptr;
+thread_local const unsigned int *active_clock = nullptr;
+
+//Directs the partition changes of this thread to a run (nullptr to stop)
+void track_memory(sim_recorder *recorder, const unsigned int *clock) {
+    active_recorder = recorder;
+    active_clock = clock;
+}
+
+std::string print_memory_header() {
+    const int tableWidth = 69 + 6 * std::size(memory_paritions);
+    std::stringstream buffer;
+
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+    buffer << "|" << std::setfill(' ')
+           << std::setw(10) << "Time" << std::setw(2) << "|"
+           << std::setw(12) << "Partitions" << std::setw(2) << "|"
+           << std::setw(11) << "Total Free" << std::setw(2) << "|"
+           << std::setw(12) << "Usable Free" << std::setw(2) << "|"
+           << std::setw(14) << "Fragmentation" << std::setw(2) << "|";
+    for(const auto &partition : memory_paritions) {
+        buffer << std::setw(4) << ("P" + std::to_string(partition.partition_number)) << std::setw(2) << "|";
+    }
+    buffer << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+//One row describing the partition table: partitions in use, free memory (total, and usable
+//i.e. in free partitions), internal fragmentation and the PID holding each partition
+std::string print_memory_status(unsigned int current_time) {
+    unsigned int in_use = 0, total_free = 0, usable_free = 0, fragmentation = 0;
+    for(const auto &partition : memory_paritions) {
+        if(partition.occupied == -1) {
+            usable_free += partition.size;
+            total_free += partition.size;
+        } else {
+            in_use++;
+            fragmentation += partition.size - partition.used;
+            total_free += partition.size - partition.used;
+        }
+    }
+
+    std::stringstream buffer;
+    buffer << "|" << std::setfill(' ')
+           << std::setw(10) << current_time << std::setw(2) << "|"
+           << std::setw(12) << (std::to_string(in_use) + "/" + std::to_string(std::size(memory_paritions))) << std::setw(2) << "|"
+           << std::setw(11) << total_free << std::setw(2) << "|"
+           << std::setw(12) << usable_free << std::setw(2) << "|"
+           << std::setw(14) << fragmentation << std::setw(2) << "|";
+    for(const auto &partition : memory_paritions) {
+        buffer << std::setw(4) << (partition.occupied == -1 ? "-" : std::to_string(partition.occupied)) << std::setw(2) << "|";
+    }
+    buffer << std::endl;
+
+    return buffer.str();
+}
+
+void record_memory_status() {
+    if(active_recorder == nullptr) {
+        return;
+    }
+    sim_recorder &recorder = *active_recorder;
+    unsigned int current_time = *active_clock;
+
+    // Sinks see the change when it happens, not at the next transition
+    for(auto &sink : recorder.sinks) {
+        sink->record_memory(current_time);
+    }
+    if(!recorder.memory_tracking) {
+        return;
+    }
+
+    std::string row = print_memory_status(current_time);
+    if(recorder.memory_interval == 0) {
+        recorder.memory_status += row;
+        return;
+    }
+
+    // Downsampling: one row per interval, the latest change of the interval, written once a later interval starts
+    if(current_time >= recorder.next_memory_sample) {
+        recorder.memory_status += recorder.pending_memory_row;
+        recorder.next_memory_sample = (current_time / recorder.memory_interval + 1) * recorder.memory_interval;
+    }
+    recorder.pending_memory_row = row;
+}
+
+//Closes the memory status table at the end of the run
+void close_memory_status(sim_recorder &recorder) {
+    if(!recorder.memory_tracking) {
+        return;
+    }
+    recorder.memory_status += recorder.pending_memory_row;
+    recorder.pending_memory_row.clear();
+    recorder.memory_status += "+" + std::string(68 + 6 * std::size(memory_paritions), '-') + "+\n";
+}
+
+//Sets up a simulation that starts at time 0
+void init_simulation(sim_state &state, const std::vector<PCB> &list_processes, const sim_config &config) {
+    state = sim_state();
+    state.list_processes = list_processes;
+    state.quantum_remaining = config.time_quantum;
+
+    // Initialize an empty running process
+    idle_CPU(state.running);
+
+    reset_memory();
+    init_io(state.io, config, state.recorder.metrics);
+
+    // Create output table header
+    state.recorder.execution_status = print_exec_header();
+    state.recorder.filter = config.filter;
+
+    state.recorder.memory_tracking = config.memory_status;
+    state.recorder.memory_interval = config.memory_interval;
+    if(config.memory_status) {
+        state.recorder.memory_status = print_memory_header();
+    }
+}
+
+//Drops the processes that have arrived from the arrival list, they are in the queues now (or were never admitted)
+void forget_arrivals(sim_state &state) {
+    auto arrived = std::remove_if(state.list_processes.begin(), state.list_processes.end(), [&](const PCB &process) {
+        return process.arrival_time < state.current_time;
+    });
+    state.list_processes.erase(arrived, state.list_processes.end());
+}
+
+//Returns true once all admitted processes have terminated
+bool simulation_done(const sim_state &state) {
+    return all_process_terminated(state.job_list) && !state.job_list.empty();
+}
+
+//Appends the pending part of the execution table to the output file
+void flush_output(sim_recorder &recorder) {
+    if(recorder.output_file.empty() || recorder.execution_status.empty()) {
+        return;
+    }
+    std::ofstream output_file(recorder.output_file, std::ios::binary | std::ios::app);
+    output_file << recorder.execution_status;
+    recorder.output_position += recorder.execution_status.size();
+    recorder.execution_status.clear();
+}
+
+//Appends the pending part of the memory status table to its file
+void flush_memory_status(sim_recorder &recorder) {
+    if(recorder.memory_file.empty() || recorder.memory_status.empty()) {
+        return;
+    }
+    std::ofstream memory_file(recorder.memory_file, std::ios::binary | std::ios::app);
+    memory_file << recorder.memory_status;
+    recorder.memory_position += recorder.memory_status.size();
+    recorder.memory_status.clear();
+}
+
+//Quantum to hand to a process being dispatched
+//In adaptive mode the quantum covers 80% of the recently observed CPU bursts
+unsigned int next_quantum(const sim_config &config, const sim_recorder &recorder) {
+    const std::vector<unsigned int> &bursts = recorder.metrics.recent_bursts;
+    if(!config.adaptive_quantum || bursts.empty()) {
+        return config.time_quantum;
+    }
+
+    std::vector<unsigned int> sorted_bursts = bursts;
+    std::size_t rank = (sorted_bursts.size() * 8) / 10;
+    if(rank >= sorted_bursts.size()) {
+        rank = sorted_bursts.size() - 1;
+    }
+    std::nth_element(sorted_bursts.begin(), sorted_bursts.begin() + rank, sorted_bursts.end());
+
+    return std::max(1u, sorted_bursts[rank]);
+}
+
+//Nearest-rank percentile of a list of values
+double percentile(std::vector<double> values, double p) {
+    if(values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    std::size_t rank = (std::size_t) std::ceil(p / 100.0 * values.size());
+    if(rank > 0) {
+        rank--;
+    }
+    return values[std::min(rank, values.size() - 1)];
+}
+
+double mean(const std::vector<double> &values) {
+    if(values.empty()) {
+        return 0;
+    }
+    double total = 0;
+    for(double value : values) {
+        total += value;
+    }
+    return total / values.size();
+}
+
+//Summary of the metrics over all the processes
+struct metrics_summary {
+    unsigned int    completed = 0;
+    double          mean_turnaround = 0;
+    double          mean_response = 0;
+    double          p99_response = 0;
+    double          mean_wait = 0;
+    double          throughput = 0;     // Processes completed per second of simulated time
+};
+
+metrics_summary summarize(const sim_metrics &metrics) {
+    std::vector<double> turnaround, response, wait;
+
+    for(const auto &entry : metrics.processes) {
+        const process_stats &stats = entry.second;
+        if(stats.first_run != -1) {
+            response.push_back(stats.first_run - stats.arrival);
+        }
+        if(stats.completion != -1) {
+            turnaround.push_back(stats.completion - stats.arrival);
+            wait.push_back(stats.wait_time);
+        }
+    }
+
+    metrics_summary summary;
+    summary.completed = turnaround.size();
+    summary.mean_turnaround = mean(turnaround);
+    summary.mean_response = mean(response);
+    summary.p99_response = percentile(response, 99);
+    summary.mean_wait = mean(wait);
+    if(metrics.last_event > 0) {
+        summary.throughput = summary.completed * 1000.0 / metrics.last_event;
+    }
+
+    return summary;
+}
+
+double objective_value(const metrics_summary &summary, enum objectives objective) {
+    switch(objective) {
+        case MEAN_RESPONSE:     return summary.mean_response;
+        case P99_RESPONSE:      return summary.p99_response;
+        case MEAN_WAIT:         return summary.mean_wait;
+        default:                return summary.mean_turnaround;
+    }
+}
+
+std::string objective_name(enum objectives objective) {
+    switch(objective) {
+        case MEAN_RESPONSE:     return "mean response";
+        case P99_RESPONSE:      return "p99 response";
+        case MEAN_WAIT:         return "mean wait";
+        default:                return "mean turnaround";
+    }
+}
+
+std::string print_metrics(const sim_metrics &metrics) {
+    metrics_summary summary = summarize(metrics);
+    std::stringstream buffer;
+
+    buffer << std::fixed << std::setprecision(2)
+           << "Completed processes:    " << summary.completed << std::endl
+           << "Mean turnaround time:   " << summary.mean_turnaround << " ms" << std::endl
+           << "Mean response time:     " << summary.mean_response << " ms" << std::endl
+           << "p99 response time:      " << summary.p99_response << " ms" << std::endl
+           << "Mean wait time:         " << summary.mean_wait << " ms" << std::endl
+           << "Throughput:             " << summary.throughput << " processes/s" << std::endl
+           << "Useful CPU time:        " << metrics.useful_time << " ms" << std::endl
+           << "Overhead CPU time:      " << metrics.overhead_time << " ms";
+    if(metrics.useful_time + metrics.overhead_time > 0) {
+        buffer << " (" << 100.0 * metrics.overhead_time / (metrics.useful_time + metrics.overhead_time) << "% of busy time)";
+    }
+    buffer << std::endl;
+
+    return buffer.str();
+}
+
+std::string print_swap_report(const sim_metrics &metrics, const sim_metrics &without_swapping) {
+    metrics_summary with = summarize(metrics);
+    metrics_summary without = summarize(without_swapping);
+    std::stringstream buffer;
+
+    buffer << "Swap-outs:              " << metrics.swap_outs << std::endl
+           << "Swap-ins:               " << metrics.swap_ins << std::endl
+           << "Swap traffic:           " << metrics.swap_traffic << " MB" << std::endl
+           << std::fixed << std::setprecision(2)
+           << "Without swapping:       " << without.completed << " processes completed, "
+           << without.throughput << " processes/s" << std::endl
+           << "Gained by swapping:     " << (int) with.completed - (int) without.completed << " processes, "
+           << with.throughput - without.throughput << " processes/s" << std::endl;
+
+    return buffer.str();
+}
+
+//Parses "OLD->NEW[,OLD->NEW...]" into transition patterns, * matches any state
+bool parse_transition_patterns(const std::string &list, std::vector<transition_pattern> &patterns) {
+    const std::vector<std::string> names = {"NEW", "READY", "RUNNING", "WAITING", "TERMINATED", "NOT_ASSIGNED", "SUSPENDED"};
+    auto state_index = [&](const std::string &name) {
+        if(name == "*") {
+            return -1;
+        }
+        auto found = std::find(names.begin(), names.end(), name);
+        return (found == names.end()) ? -2 : (int) (found - names.begin());
+    };
+
+    for(const auto &item : split_delim(list, ",")) {
+        auto ends = split_delim(item, "->");
+        if(ends.size() != 2) {
+            return false;
+        }
+        transition_pattern pattern = {state_index(ends[0]), state_index(ends[1])};
+        if(pattern.old_state == -2 || pattern.new_state == -2) {
+            return false;
+        }
+        patterns.push_back(pattern);
+    }
+    return !patterns.empty();
+}
+
+//Parses the options following the input file, returns false on an invalid option
+//Reads the value of a numeric option, prints what was expected if it is not a whole number of at least lowest
+bool option_number(const std::string &option, const std::string &text, unsigned int &value, unsigned int lowest = 0) {
+    if(!parse_unsigned(text, value) || value < lowest) {
+        std::cerr << "Expected " << option << " <number>, a whole number of at least " << lowest << ", got " << text << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parse_options(int argc, char** argv, sim_config &config) {
+    for(int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        // EP has no time quantum, its options are refused rather than ignored
+        if(config.policy == "EP" && (option == "--quantum" || option == "--adaptive-quantum"
+                                     || option == "--tune" || option == "--tune-range")) {
+            std::cerr << "Error: " << option << " does not apply to EP, it has no time quantum" << std::endl;
+            return false;
+        }
+
+        if(option == "--quantum" && has_value) {
+            if(!option_number(option, argv[++i], config.time_quantum, 1)) {
+                return false;
+            }
+        } else if(option == "--adaptive-quantum") {
+            config.adaptive_quantum = true;
+        } else if(option == "--context-switch" && has_value) {
+            if(!option_number(option, argv[++i], config.context_switch_cost)) {
+                return false;
+            }
+        } else if(option == "--scheduler-cost" && has_value) {
+            if(!option_number(option, argv[++i], config.scheduler_cost)) {
+                return false;
+            }
+        } else if(option == "--scheduler-cost-per-ready" && has_value) {
+            if(!parse_decimal(argv[++i], config.scheduler_cost_per_ready)) {
+                std::cerr << "Expected " << option << " <ms>, a number of at least 0, got " << argv[i] << std::endl;
+                return false;
+            }
+        } else if(option == "--admission-cost" && has_value) {
+            if(!option_number(option, argv[++i], config.admission_cost)) {
+                return false;
+            }
+        } else if(option == "--io-devices" && has_value) {
+            if(!option_number(option, argv[++i], config.io_devices)) {
+                return false;
+            }
+        } else if(option == "--io-queue" && has_value) {
+            std::string policy = argv[++i];
+            if(policy != "fifo" && policy != "priority") {
+                std::cerr << "Expected --io-queue fifo|priority" << std::endl;
+                return false;
+            }
+            config.io_priority_queue = (policy == "priority");
+        } else if(option == "--swap" && has_value) {
+            std::string policy = argv[++i];
+            config.swapping = true;
+            if(policy == "longest-blocked") {
+                config.swap_policy = LONGEST_BLOCKED;
+            } else if(policy == "lowest-priority") {
+                config.swap_policy = LOWEST_PRIORITY;
+            } else {
+                std::cerr << "Expected --swap longest-blocked|lowest-priority" << std::endl;
+                return false;
+            }
+        } else if(option == "--swap-cost" && has_value) {
+            if(!option_number(option, argv[++i], config.swap_cost)) {
+                return false;
+            }
+        } else if(option == "--checkpoint" && has_value) {
+            config.checkpoint_file = argv[++i];
+        } else if(option == "--checkpoint-interval" && has_value) {
+            if(!option_number(option, argv[++i], config.checkpoint_interval)) {
+                return false;
+            }
+        } else if(option == "--resume" && has_value) {
+            config.resume_file = argv[++i];
+        } else if(option == "--fork" && has_value) {
+            config.fork_spec = argv[++i];
+        } else if(option == "--fork-at" && has_value) {
+            if(!option_number(option, argv[++i], config.fork_time)) {
+                return false;
+            }
+        } else if(option == "--binary-trace" && has_value) {
+            config.binary_trace_file = argv[++i];
+        } else if(option == "--snapshot-every" && has_value) {
+            if(!option_number(option, argv[++i], config.snapshot_every, 1)) {
+                return false;
+            }
+        } else if(option == "--chrome-trace" && has_value) {
+            config.chrome_trace_file = argv[++i];
+        } else if(option == "--memory-status") {
+            config.memory_status = true;
+        } else if(option == "--memory-interval" && has_value) {
+            if(!option_number(option, argv[++i], config.memory_interval)) {
+                return false;
+            }
+        } else if(option == "--trace-pids" && has_value) {
+            config.filter.PIDs.clear();
+            if(!parse_PIDs(argv[++i], config.filter.PIDs)) {
+                std::cerr << "Expected --trace-pids <PID>[,<PID>...], got " << argv[i] << std::endl;
+                return false;
+            }
+            std::sort(config.filter.PIDs.begin(), config.filter.PIDs.end());
+        } else if(option == "--trace-transitions" && has_value) {
+            config.filter.transitions.clear();
+            if(!parse_transition_patterns(argv[++i], config.filter.transitions)) {
+                std::cerr << "Expected --trace-transitions <OLD>-><NEW>[,...] (state names or *)" << std::endl;
+                return false;
+            }
+        } else if(option == "--trace-window" && has_value) {
+            auto bounds = split_delim(argv[++i], ":");
+            if(bounds.size() != 2 || !parse_unsigned(bounds[0], config.filter.from_time)
+               || !parse_unsigned(bounds[1], config.filter.until_time) || config.filter.until_time < config.filter.from_time) {
+                std::cerr << "Expected --trace-window <from>:<until>, whole numbers with from <= until, got " << argv[i] << std::endl;
+                return false;
+            }
+        } else if(option == "--trace-sample" && has_value) {
+            if(!option_number(option, argv[++i], config.filter.sample_every, 1)) {
+                return false;
+            }
+        } else if(option == "--trace-last" && has_value) {
+            unsigned int keep_last = 0;
+            if(!option_number(option, argv[++i], keep_last)) {
+                return false;
+            }
+            config.filter.keep_last = keep_last;
+        } else if(option == "--no-text-trace") {
+            config.text_trace = false;
+        } else if(option == "--daemon") {
+            config.daemon = true;
+        } else if(option == "--socket" && has_value) {
+            config.daemon = true;
+            config.socket_path = argv[++i];
+        } else if(option == "--replicas" && has_value) {
+            if(!option_number(option, argv[++i], config.replicas)) {
+                return false;
+            }
+        } else if(option == "--seed" && has_value) {
+            if(!option_number(option, argv[++i], config.seed)) {
+                return false;
+            }
+        } else if(option == "--import" && has_value) {
+            config.import_format = argv[++i];
+            if(config.import_format != "perf" && config.import_format != "proc") {
+                std::cerr << "Expected --import perf|proc" << std::endl;
+                return false;
+            }
+        } else if(option == "--import-tick-us" && has_value) {
+            if(!option_number(option, argv[++i], config.import_tick_us, 1)) {
+                return false;
+            }
+        } else if(option == "--import-size" && has_value) {
+            if(!option_number(option, argv[++i], config.import_size, 1)) {
+                return false;
+            }
+        } else if(option == "--pipeline") {
+            config.pipeline = true;
+        } else if(option == "--engine" && has_value) {
+            std::string engine = argv[++i];
+            if(engine != "reference" && engine != "soa") {
+                std::cerr << "Expected --engine reference|soa" << std::endl;
+                return false;
+            }
+            config.engine = (engine == "soa") ? TABLE_ENGINE : REFERENCE_ENGINE;
+        } else if(option == "--tune" && has_value) {
+            std::string objective = argv[++i];
+            config.tune = true;
+            if(objective == "turnaround") {
+                config.objective = MEAN_TURNAROUND;
+            } else if(objective == "response") {
+                config.objective = MEAN_RESPONSE;
+            } else if(objective == "p99_response") {
+                config.objective = P99_RESPONSE;
+            } else if(objective == "wait") {
+                config.objective = MEAN_WAIT;
+            } else {
+                std::cerr << "Unknown objective: " << objective << std::endl;
+                return false;
+            }
+        } else if(option == "--tune-range" && has_value) {
+            auto bounds = split_delim(argv[++i], ":");
+            if(bounds.size() != 2 || !parse_unsigned(bounds[0], config.tune_min) || !parse_unsigned(bounds[1], config.tune_max)
+               || config.tune_min < 1 || config.tune_max < config.tune_min) {
+                std::cerr << "Expected --tune-range <min>:<max>, whole numbers with 1 <= min <= max, got " << argv[i] << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------QUANTUM TUNING---------------------------------------------
+
+struct quantum_tuning {
+    unsigned int                    best_quantum;
+    double                          best_value;
+    std::map<unsigned int, double>  curve;      // Objective value for every quantum evaluated
+};
+
+//The tuner only runs the workload to completion at many fixed quanta, returns false (with an error) for the
+//options it would otherwise ignore
+bool tune_compatible(const sim_config &config) {
+    std::string mode;
+    if(config.adaptive_quantum) {
+        mode = "--adaptive-quantum";
+    } else if(!config.fork_spec.empty()) {
+        mode = "--fork";
+    } else if(config.replicas > 0) {
+        mode = "--replicas";
+    } else if(config.daemon) {
+        mode = "--daemon";
+    } else if(!config.checkpoint_file.empty() || !config.resume_file.empty()) {
+        mode = "checkpoints";
+    } else if(!config.binary_trace_file.empty() || !config.chrome_trace_file.empty() || config.memory_status) {
+        mode = "--binary-trace, --chrome-trace or --memory-status";
+    } else if(filtering(config.filter) || config.filter.keep_last > 0) {
+        mode = "the trace filters";
+    }
+    if(!mode.empty()) {
+        std::cerr << "Error: --tune cannot be combined with " << mode << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//Searches the quantum range for the value minimizing the objective.
+//Each round evaluates a grid of quanta in parallel, then narrows the range around the best one.
+template<typename Simulator>
+quantum_tuning tune_quantum(Simulator simulate, const std::vector<PCB> &list_processes, sim_config config) {
+    quantum_tuning result;
+    unsigned int workers = std::max(4u, std::thread::hardware_concurrency());
+    unsigned int low = config.tune_min;
+    unsigned int high = config.tune_max;
+    config.tune = false;
+    config.adaptive_quantum = false;
+    config.checkpoint_file.clear();
+    config.memory_status = false;
+
+    while(true) {
+        // Pick the grid for this round, skipping quanta that were already simulated
+        std::vector<unsigned int> candidates;
+        unsigned int step = std::max(1u, (high - low) / (workers - 1));
+        for(unsigned int quantum = low; quantum <= high; quantum += step) {
+            if(result.curve.find(quantum) == result.curve.end()) {
+                candidates.push_back(quantum);
+            }
+        }
+        if(result.curve.find(high) == result.curve.end() && (candidates.empty() || candidates.back() != high)) {
+            candidates.push_back(high);
+        }
+
+        std::vector<double> values(candidates.size());
+        std::vector<std::thread> threads;
+        for(std::size_t i = 0; i < candidates.size(); i++) {
+            threads.emplace_back([&, i]() {
+                sim_config run_config = config;
+                run_config.time_quantum = candidates[i];
+                auto [exec, metrics, memory] = simulate(list_processes, run_config);
+                values[i] = objective_value(summarize(metrics), config.objective);
+            });
+        }
+        for(auto &thread : threads) {
+            thread.join();
+        }
+        for(std::size_t i = 0; i < candidates.size(); i++) {
+            result.curve[candidates[i]] = values[i];
+        }
+
+        // Lowest value wins, the smaller quantum wins ties
+        result.best_quantum = result.curve.begin()->first;
+        result.best_value = result.curve.begin()->second;
+        for(const auto &point : result.curve) {
+            if(point.second < result.best_value) {
+                result.best_quantum = point.first;
+                result.best_value = point.second;
+            }
+        }
+
+        if(step == 1) {
+            break;
+        }
+        low = (result.best_quantum > config.tune_min + step) ? result.best_quantum - step : config.tune_min;
+        high = std::min(result.best_quantum + step, config.tune_max);
+    }
+
+    return result;
+}
+
+std::string print_tuning(const quantum_tuning &result, enum objectives objective) {
+    std::stringstream buffer;
+
+    buffer << "+" << std::setfill('-') << std::setw(30) << "+" << std::endl;
+    buffer << "|" << std::setfill(' ') << std::setw(8) << "Quantum"
+           << std::setw(2) << "|" << std::setw(17) << objective_name(objective)
+           << std::setw(2) << "|" << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(30) << "+" << std::endl;
+    for(const auto &point : result.curve) {
+        buffer << "|" << std::setfill(' ') << std::setw(8) << point.first
+               << std::setw(2) << "|" << std::setw(17) << std::fixed << std::setprecision(2) << point.second
+               << std::setw(2) << "|" << std::endl;
+    }
+    buffer << "+" << std::setfill('-') << std::setw(30) << "+" << std::endl;
+    buffer << "Best quantum: " << result.best_quantum << " ms (" << objective_name(objective)
+           << " = " << result.best_value << " ms)" << std::endl;
+
+    return buffer.str();
 }
 
 #endif
\ No newline at end of file
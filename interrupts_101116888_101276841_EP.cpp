@@ -10,6 +10,16 @@
  */
 
 #include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_checkpoint.hpp"
+#include "interrupts_101116888_101276841_fork.hpp"
+#include "interrupts_101116888_101276841_trace.hpp"
+#include "interrupts_101116888_101276841_snapshot.hpp"
+#include "interrupts_101116888_101276841_timeline.hpp"
+#include "interrupts_101116888_101276841_soa.hpp"
+#include "interrupts_101116888_101276841_pipeline.hpp"
+#include "interrupts_101116888_101276841_daemon.hpp"
+#include "interrupts_101116888_101276841_montecarlo.hpp"
+#include "interrupts_101116888_101276841_import.hpp"
 
 /**
  * External Priorities scheduling function
@@ -31,155 +41,285 @@ void external_priorities(std::vector<PCB> &ready_queue) {
 }
 
 /**
- * Main simulation function for External Priorities scheduler
- * Returns tuple of execution status string (and memory status for bonus)
+ * External Priorities order for a queue of process table handles
+ * Same comparisons as above, so processes of equal priority end up in the same order
  */
-std::tuple<std::string> run_simulation(std::vector<PCB> list_processes) {
-
-    std::vector<PCB> ready_queue;   // Processes ready to run
-    std::vector<PCB> wait_queue;    // Processes waiting for I/O completion
-    std::vector<PCB> job_list;      // All processes for tracking
-
-    unsigned int current_time = 0;
-    unsigned int io_start_time = 0; // Track when I/O started
-    PCB running;
-
-    // Initialize an empty running process
-    idle_CPU(running);
-
-    std::string execution_status;
-
-    // Create output table header
-    execution_status = print_exec_header();
-
-    // Main simulation loop - continues until all processes terminate
-    while(!all_process_terminated(job_list) || job_list.empty()) {
-
-        //============================================================================
-        // STEP 1: POPULATE READY QUEUE - New processes arriving at current time
-        //============================================================================
-        for(auto &process : list_processes) {
-            if(process.arrival_time == current_time) {
-                // Try to assign memory partition
-                bool memory_assigned = assign_memory(process);
-                
-                if(memory_assigned) {
-                    // Memory available - add to ready queue
-                    process.state = READY;
-                    ready_queue.push_back(process);
-                    job_list.push_back(process);
-                    execution_status += print_exec_status(current_time, process.PID, NEW, READY);
-                } else {
-                    // No memory available - process must wait
-                    // In real system, would stay in NEW state until memory available
-                    // For this simulation, we'll keep checking each cycle
-                }
+void external_priorities(const process_table &table, std::vector<process_handle> &ready_queue) {
+    const auto &priority = table.priority;
+    const auto &arrival_time = table.arrival_time;
+    std::sort(
+        ready_queue.begin(),
+        ready_queue.end(),
+        [&](process_handle first, process_handle second) {
+            if(priority[first] == priority[second]) {
+                return (arrival_time[first] > arrival_time[second]);
             }
+            return (priority[first] > priority[second]);
         }
+    );
+}
 
-        //============================================================================
-        // STEP 2: MANAGE WAIT QUEUE - Check for I/O completion
-        //============================================================================
-        std::vector<PCB> still_waiting;
-        for(auto &process : wait_queue) {
-            // Calculate how long process has been waiting
-            unsigned int wait_time = current_time - io_start_time;
+/**
+ * Advances the External Priorities simulation by 1ms
+ */
+void simulate_tick(sim_state &state, const sim_config &config) {
+
+    // The steps below work on the simulation state under their usual names
+    auto &list_processes = state.list_processes;
+    auto &ready_queue = state.ready_queue;
+    auto &wait_queue = state.wait_queue;
+    auto &job_list = state.job_list;
+    auto &running = state.running;
+    auto &current_time = state.current_time;
+    auto &overhead_pending = state.overhead_pending;
+    auto &io_start_time = state.io_start_time;
+    auto &recorder = state.recorder;
+    auto &io = state.io;
+    auto &swap = state.swap;
+
+    //============================================================================
+    // STEP 1: POPULATE READY QUEUE - New processes arriving at current time
+    //============================================================================
+    for(auto &process : list_processes) {
+        if(process.arrival_time == current_time) {
+            // Try to assign memory partition
+            bool memory_assigned = assign_memory(process);
             
-            if(wait_time >= process.io_duration) {
-                // I/O complete - move back to ready queue
+            if(memory_assigned) {
+                // Memory available - add to ready queue
                 process.state = READY;
                 ready_queue.push_back(process);
-                sync_queue(job_list, process);
-                execution_status += print_exec_status(current_time, process.PID, WAITING, READY);
-            } else {
-                // Still waiting for I/O
-                still_waiting.push_back(process);
+                job_list.push_back(process);
+                record_transition(recorder, current_time, process.PID, NEW, READY);
+                overhead_pending += config.admission_cost;
+            } else if(config.swapping) {
+                // No memory available - stays NEW until the medium-term scheduler frees a partition
+                queue_admission(swap, process, job_list, recorder.metrics, current_time);
             }
         }
-        wait_queue = still_waiting;
+    }
+
+    //============================================================================
+    // STEP 2: MANAGE WAIT QUEUE - Check for I/O completion
+    //============================================================================
+    advance_io(io, current_time, recorder.metrics);
+    std::vector<PCB> still_waiting;
+    for(auto &process : wait_queue) {
+        // Calculate how long process has been waiting
+        unsigned int wait_time = current_time - io_start_time;
+        
+        bool io_done = io_finished(io, process, wait_time);
+        if(io_done && process.state == SUSPENDED) {
+            // Swapped out during its I/O - stays suspended until it is swapped back in
+            swap.suspended.push_back(process);
+            observe_io_completion(recorder.metrics, current_time, process.PID);
+        } else if(io_done) {
+            // I/O complete - move back to ready queue
+            process.state = READY;
+            ready_queue.push_back(process);
+            sync_queue(job_list, process);
+            record_transition(recorder, current_time, process.PID, WAITING, READY);
+        } else {
+            // Still waiting for I/O
+            still_waiting.push_back(process);
+        }
+    }
+    wait_queue = still_waiting;
 
-        //============================================================================
-        // STEP 3: HANDLE RUNNING PROCESS
-        //============================================================================
-        if(running.state == RUNNING) {
-            // Process is currently running - execute for 1ms
-            running.remaining_time--;
+    //============================================================================
+    // STEP 2B: MEDIUM-TERM SCHEDULER - Swapping when memory partitions are full
+    //============================================================================
+    medium_term_schedule(swap, config, ready_queue, wait_queue, job_list, recorder, current_time);
+
+    //============================================================================
+    // STEP 3: HANDLE RUNNING PROCESS
+    //============================================================================
+    if(spend_overhead(overhead_pending, recorder.metrics)) {
+        // CPU is busy with context switch, scheduling or admission work this ms
+    } else if(running.state == RUNNING) {
+        // Process is currently running - execute for 1ms
+        recorder.metrics.useful_time++;
+        running.remaining_time--;
+        
+        // Check if process needs I/O
+        if(running.remaining_time > 0) {
+            // Calculate if I/O should trigger
+            unsigned int time_since_start = running.processing_time - running.remaining_time;
             
-            // Check if process needs I/O
-            if(running.io_freq > 0 && running.remaining_time > 0) {
-                // Calculate if I/O should trigger
-                unsigned int time_since_start = running.processing_time - running.remaining_time;
+            if(io_due(running, time_since_start)) {
+                // Time for I/O - move to wait queue
+                running.state = WAITING;
+                io_start_time = current_time;
+                wait_queue.push_back(running);
+                submit_io(io, running, current_time);
+                sync_queue(job_list, running);
+                record_transition(recorder, current_time, running.PID, RUNNING, WAITING);
                 
-                if(time_since_start > 0 && time_since_start % running.io_freq == 0) {
-                    // Time for I/O - move to wait queue
-                    running.state = WAITING;
-                    io_start_time = current_time;
-                    wait_queue.push_back(running);
-                    sync_queue(job_list, running);
-                    execution_status += print_exec_status(current_time, running.PID, RUNNING, WAITING);
-                    
-                    // CPU becomes idle
-                    idle_CPU(running);
-                }
-            }
-            
-            // Check if process completed
-            if(running.remaining_time == 0) {
-                // Process finished
-                execution_status += print_exec_status(current_time, running.PID, RUNNING, TERMINATED);
-                terminate_process(running, job_list);
+                // CPU becomes idle
                 idle_CPU(running);
             }
         }
+        
+        // Check if process completed
+        if(running.remaining_time == 0) {
+            // Process finished
+            record_transition(recorder, current_time, running.PID, RUNNING, TERMINATED);
+            terminate_process(running, job_list);
+            idle_CPU(running);
+        }
+    }
 
-        //============================================================================
-        // STEP 4: SCHEDULE NEW PROCESS (if CPU is idle)
-        //============================================================================
-        if(running.state == NOT_ASSIGNED && !ready_queue.empty()) {
-            // CPU is idle and we have processes ready - schedule one
-            external_priorities(ready_queue); // Sort by priority
-            
-            // Get highest priority process (at back of vector after sorting)
-            running = ready_queue.back();
-            ready_queue.pop_back();
-            
-            // Set start time if first time running
-            if(running.start_time == -1) {
-                running.start_time = current_time;
+    //============================================================================
+    // STEP 4: SCHEDULE NEW PROCESS (if CPU is idle)
+    //============================================================================
+    if(running.state == NOT_ASSIGNED && !ready_queue.empty()) {
+        // CPU is idle and we have processes ready - schedule one
+        overhead_pending += dispatch_cost(config, ready_queue.size());
+        external_priorities(ready_queue); // Sort by priority
+        
+        // Get highest priority process (at back of vector after sorting)
+        running = ready_queue.back();
+        ready_queue.pop_back();
+        
+        // Set start time if first time running
+        if(running.start_time == -1) {
+            running.start_time = current_time;
+        }
+        
+        running.state = RUNNING;
+        sync_queue(job_list, running);
+        record_transition(recorder, current_time, running.PID, READY, RUNNING);
+    }
+
+    //============================================================================
+    // ADVANCE TIME
+    //============================================================================
+    current_time++;
+}
+
+/**
+ * Advances the External Priorities simulation by 1ms on the process table
+ * Same steps as simulate_tick, the queues hold handles into the table
+ */
+void simulate_table_tick(table_state &state, const sim_config &config) {
+
+    process_table &table = state.table;
+    auto &ready_queue = state.ready_queue;
+    auto &wait_queue = state.wait_queue;
+    auto &running = state.running;
+    auto &current_time = state.current_time;
+    auto &recorder = state.recorder;
+
+    // STEP 1: POPULATE READY QUEUE
+    admit_arrivals(state, config);
+
+    // STEP 2: MANAGE WAIT QUEUE - every wait is measured from the last I/O start
+    advance_io(state.io, current_time, recorder.metrics);
+    std::size_t still_waiting = 0;
+    for(auto process : wait_queue) {
+        unsigned int wait_time = current_time - state.io_start_time;
+        if(io_finished(state.io, table.PID[process], io_length(table, process), wait_time)) {
+            table.state[process] = READY;
+            ready_queue.push_back(process);
+            record_transition(recorder, current_time, table.PID[process], WAITING, READY);
+        } else {
+            wait_queue[still_waiting++] = process;
+        }
+    }
+    wait_queue.resize(still_waiting);
+
+    // STEP 3: HANDLE RUNNING PROCESS
+    if(spend_overhead(state.overhead_pending, recorder.metrics)) {
+        // CPU is busy with OS work this ms
+    } else if(running != NO_PROCESS) {
+        recorder.metrics.useful_time++;
+        unsigned int remaining_time = --table.remaining_time[running];
+
+        if(remaining_time > 0) {
+            unsigned int time_since_start = table.processing_time[running] - remaining_time;
+            if(io_due(table, running, time_since_start)) {
+                state.io_start_time = current_time;
+                start_io(state);
             }
-            
-            running.state = RUNNING;
-            sync_queue(job_list, running);
-            execution_status += print_exec_status(current_time, running.PID, READY, RUNNING);
         }
 
-        //============================================================================
-        // ADVANCE TIME
-        //============================================================================
-        current_time++;
-        
+        if(running == NO_PROCESS) {
+            // As in simulate_tick, the idle CPU left by the I/O request has no remaining time
+            // and is reported terminated under PID -1
+            record_transition(recorder, current_time, -1, RUNNING, TERMINATED);
+        } else if(remaining_time == 0) {
+            terminate_running(state);
+        }
+    }
+
+    // STEP 4: SCHEDULE NEW PROCESS
+    if(running == NO_PROCESS && !ready_queue.empty()) {
+        state.overhead_pending += dispatch_cost(config, ready_queue.size());
+        external_priorities(table, ready_queue);
+        dispatch_back(state);
+    }
+
+    current_time++;
+}
+
+/**
+ * Main simulation function for External Priorities scheduler
+ * Runs (or resumes) the simulation held in state until all processes terminate
+ * Returns tuple of execution status string, metrics and memory status
+ */
+std::tuple<std::string, sim_metrics, std::string> run_simulation(sim_state &state, const sim_config &config) {
+
+    // Partition changes are logged into this run's recorder
+    track_memory(&state.recorder, &state.current_time);
+
+    // Main simulation loop - continues until all processes terminate
+    while(!simulation_done(state)) {
+        simulate_tick(state, config);
+        finish_tick(state);
+        checkpoint_if_due(state, config);
+
         // Safety check - prevent infinite loop (adjust as needed for your test cases)
-        if(current_time > 100000) {
+        if(state.current_time > 100000) {
             std::cerr << "Simulation timeout at 100000ms" << std::endl;
             break;
         }
     }
-    
-    // Close the output table
-    execution_status += print_exec_footer();
 
-    return std::make_tuple(execution_status);
+    // Final checkpoint, resuming from it only closes the table
+    if(!config.checkpoint_file.empty()) {
+        save_checkpoint(state, config);
+    }
+
+    // Close the output tables
+    close_execution_table(state.recorder);
+    close_memory_status(state.recorder);
+    track_memory(nullptr, nullptr);
+
+    return std::make_tuple(state.recorder.execution_status, state.recorder.metrics, state.recorder.memory_status);
 }
 
+std::tuple<std::string, sim_metrics, std::string> run_simulation(std::vector<PCB> list_processes, const sim_config &config) {
+    sim_state state;
+    init_simulation(state, list_processes, config);
+    return run_simulation(state, config);
+}
 
 int main(int argc, char** argv) {
 
     // Validate command line arguments
-    if(argc != 2) {
+    sim_config config;
+    config.policy = "EP";
+    if(argc < 2) {
         std::cout << "ERROR!\nExpected 1 argument, received " << argc - 1 << std::endl;
-        std::cout << "To run the program, do: ./interrupts_EP <your_input_file.txt>" << std::endl;
+        std::cout << "To run the program, do: ./interrupts_EP <your_input_file.txt> [options]" << std::endl;
         return -1;
     }
+    if(!parse_options(argc, argv, config)) {
+        std::cout << "To run the program, do: ./interrupts_EP <your_input_file.txt> [options]" << std::endl;
+        return -1;
+    }
+
+    choose_engine(config);
 
     // Open the input file
     auto file_name = argv[1];
@@ -193,24 +333,182 @@ int main(int argc, char** argv) {
     }
 
     // Parse the entire input file and populate a vector of PCBs
-    std::string line;
+    // (a recorded scheduler trace is imported while the simulation runs instead, see run_import_simulation)
     std::vector<PCB> list_process;
-    while(std::getline(input_file, line)) {
-        auto input_tokens = split_delim(line, ", ");
-        auto new_process = add_process(input_tokens);
-        list_process.push_back(new_process);
+    bool import = !config.import_format.empty();
+    if(import) {
+        if(!import_compatible(config)) {
+            return -1;
+        }
+    } else if(!read_input_file(input_file, list_process)) {
+        return -1;
+    }
+    if(!import) {
+        input_file.close();
     }
-    input_file.close();
 
     std::cout << "External Priorities Scheduler (No Preemption)" << std::endl;
     std::cout << "Students: Rounak Mukherjee (101116888), Timur Grigoryev (101276841)" << std::endl;
-    std::cout << "Processing " << list_process.size() << " processes..." << std::endl;
+    if(import) {
+        std::cout << "Importing a " << config.import_format << " trace..." << std::endl;
+    } else {
+        std::cout << "Processing " << list_process.size() << " processes..." << std::endl;
+    }
+
+    // Monte Carlo mode: replicas of the workload with timings drawn from the distributions of the input file
+    if(config.replicas > 0) {
+        std::vector<process_distribution> workload;
+        if(!read_distributions(file_name, workload)) {
+            return -1;
+        }
+        auto simulate = [](const std::vector<PCB> &processes, const sim_config &run_config) {
+            if(run_config.engine == TABLE_ENGINE) {
+                return run_table_simulation(simulate_table_tick, processes, run_config);
+            }
+            return run_simulation(processes, run_config);
+        };
+        auto report = print_monte_carlo(run_replicas(simulate, workload, config), config.policy);
+        std::cout << report;
+        write_output(report, "monte_carlo_EP.txt");
+        return 0;
+    }
+
+    // Start the simulation, or pick it up from a checkpoint
+    sim_state state;
+    bool resume = !config.resume_file.empty();
+    if(resume) {
+        if(!load_checkpoint(state, config)) {
+            return -1;
+        }
+    } else {
+        init_simulation(state, list_process, config);
+    }
+
+    // What-if analysis: fork the run and compare the branches side by side
+    if(!config.fork_spec.empty()) {
+        std::vector<fork_branch> branches;
+        if(!parse_fork_branches(config.fork_spec, config.policy, branches)) {
+            return -1;
+        }
+        auto simulate = [](sim_state &branch_state, const sim_config &run_config) {
+            return run_simulation(branch_state, run_config);
+        };
+        auto results = fork_simulation(simulate_tick, simulate, state, config, config.fork_time, branches,
+                                       argv[0], file_name, forwarded_options(argc, argv));
+        std::cout << print_fork_comparison(results, state.current_time);
+        return 0;
+    }
+
+    // Transitions can also go to a binary trace (and the execution table can be skipped)
+    state.recorder.text_trace = config.text_trace;
+    state.recorder.filter = config.filter;
+    if(config.filter.keep_last > 0 && (config.pipeline || resume || !config.checkpoint_file.empty())) {
+        std::cerr << "Error: --trace-last cannot be combined with --pipeline or checkpoints" << std::endl;
+        return -1;
+    }
+    if(!config.binary_trace_file.empty()) {
+        if(resume) {
+            std::cerr << "Error: --binary-trace cannot be combined with --resume" << std::endl;
+            return -1;
+        }
+        auto binary_trace = open_binary_trace(config.binary_trace_file, config);
+        if(!binary_trace) {
+            return -1;
+        }
+        state.recorder.sinks.push_back(binary_trace);
+
+        // Snapshots and a time index next to the trace, for queries at any time
+        // (they are rebuilt from every transition, a filtered trace has no index)
+        if(!filtering(config.filter)) {
+            auto index = open_trace_index(config.binary_trace_file + ".idx", binary_trace, config.snapshot_every);
+            if(!index) {
+                return -1;
+            }
+            state.recorder.sinks.push_back(index);
+        }
+    }
+    if(!config.chrome_trace_file.empty()) {
+        auto timeline = open_chrome_trace(config.chrome_trace_file, config);
+        if(!timeline) {
+            return -1;
+        }
+        state.recorder.sinks.push_back(timeline);
+    }
+
+    // Service mode: processes are submitted and the clock is advanced by commands
+    if(config.daemon) {
+        if(config.pipeline || resume || !config.checkpoint_file.empty()) {
+            std::cerr << "Error: --daemon cannot be combined with --pipeline or checkpoints" << std::endl;
+            return -1;
+        }
+        return serve_simulation(simulate_tick, state, config, "execution_EP.txt");
+    }
+
+    // Pipelined mode: a writer thread formats and writes the execution table while the simulation runs
+    std::shared_ptr<pipeline_writer> table_writer;
+    if(config.pipeline && config.text_trace) {
+        if(resume || !config.checkpoint_file.empty()) {
+            std::cerr << "Error: --pipeline cannot be combined with checkpoints" << std::endl;
+            return -1;
+        }
+        table_writer = start_pipeline_writer("execution_EP.txt");
+        if(!table_writer) {
+            return -1;
+        }
+        state.recorder.text_trace = false;
+        state.recorder.sinks.push_back(table_writer);
+    }
+
+    // While checkpointing, the execution table is streamed to the file as the simulation runs
+    bool streamed = resume || !config.checkpoint_file.empty();
+    if(streamed && !open_output(state.recorder, "execution_EP.txt", resume)) {
+        return -1;
+    }
+    if(streamed && config.memory_status && !open_memory_output(state.recorder, "memory_status_EP.txt", resume)) {
+        return -1;
+    }
 
     // Run the simulation
-    auto [exec] = run_simulation(list_process);
+    auto [exec, metrics, memory] = import
+        ? run_import_simulation(simulate_tick, state, config, input_file)
+        : (config.engine == TABLE_ENGINE)
+        ? run_table_simulation(simulate_table_tick, list_process, config, &state.recorder)
+        : run_simulation(state, config);
+    if(table_writer) {
+        table_writer->finish();
+    }
+    std::cout << print_metrics(metrics);
+    std::cout << print_io_report(metrics);
+    std::cout << print_trace_summary(state.recorder);
+
+    // Compare against the same workload without swapping
+    if(config.swapping) {
+        sim_config no_swap_config = config;
+        no_swap_config.swapping = false;
+        no_swap_config.checkpoint_file.clear();
+        auto [no_swap_exec, no_swap_metrics, no_swap_memory] = import
+            ? run_import_simulation(simulate_tick, file_name, no_swap_config)
+            : run_simulation(list_process, no_swap_config);
+        std::cout << print_swap_report(metrics, no_swap_metrics);
+    }
 
     // Write output to file
-    write_output(exec, "execution_EP.txt");
+    if(config.memory_status && streamed) {
+        flush_memory_status(state.recorder);
+        std::cout << "Output generated in memory_status_EP.txt" << std::endl;
+    } else if(config.memory_status) {
+        write_output(memory, "memory_status_EP.txt");
+    }
+    if(!config.text_trace) {
+        std::cout << "Execution table skipped (--no-text-trace)" << std::endl;
+    } else if(table_writer) {
+        std::cout << "Output generated in execution_EP.txt" << std::endl;
+    } else if(streamed) {
+        flush_output(state.recorder);
+        std::cout << "Output generated in execution_EP.txt" << std::endl;
+    } else {
+        write_output(exec, "execution_EP.txt");
+    }
 
     return 0;
 }
@@ -0,0 +1,536 @@
+/**
+ * @file interrupts_101116888_101276841_checkpoint.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Checkpoint and restore of the complete simulation state
+ *
+ * A checkpoint is a compact binary image of a sim_state plus the memory
+ * partition table, and the options the run was started with. Resuming from it
+ * with the same options continues the run with identical results, other options
+ * are refused. The execution table (and the memory status table) are streamed to
+ * their files while checkpointing, the checkpoint records how much of them was
+ * written so a resumed run can truncate the files back to that point.
+ */
+
+#ifndef INTERRUPTS_CHECKPOINT_HPP_
+#define INTERRUPTS_CHECKPOINT_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+
+#include<cstdio>
+#include<filesystem>
+
+const std::uint32_t CHECKPOINT_MAGIC = 0x504b4353;   // "SCKP"
+const std::uint32_t CHECKPOINT_VERSION = 5;
+
+//------------------------------------BINARY READ/WRITE HELPERS------------------------------
+
+template<typename T>
+void write_pod(std::ostream &out, const T &value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool read_pod(std::istream &in, T &value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return (bool) in;
+}
+
+//Reads an element count, refusing one that needs more than the rest of the file (a corrupt count must not allocate)
+bool read_count(std::istream &in, std::uint32_t &count, std::size_t element_size) {
+    if(!read_pod(in, count)) {
+        return false;
+    }
+    std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff remaining = in.tellg() - position;
+    in.seekg(position);
+    if((std::uint64_t) count * element_size > (std::uint64_t) remaining) {
+        in.setstate(std::ios::failbit);
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+void write_pods(std::ostream &out, const std::vector<T> &values) {
+    write_pod(out, (std::uint32_t) values.size());
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template<typename T>
+bool read_pods(std::istream &in, std::vector<T> &values) {
+    std::uint32_t count = 0;
+    if(!read_count(in, count, sizeof(T))) {
+        return false;
+    }
+    values.resize(count);
+    in.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+    return (bool) in;
+}
+
+void write_string(std::ostream &out, const std::string &value) {
+    write_pod(out, (std::uint32_t) value.size());
+    out.write(value.data(), value.size());
+}
+
+bool read_string(std::istream &in, std::string &value) {
+    std::uint32_t length = 0;
+    if(!read_count(in, length, 1)) {
+        return false;
+    }
+    value.resize(length);
+    in.read(&value[0], length);
+    return (bool) in;
+}
+
+//------------------------------------STATE SERIALIZATION------------------------------------
+
+//A PCB is written field by field, followed by its burst schedule if it has one
+void write_process(std::ostream &out, const PCB &process) {
+    write_pod(out, process.PID);
+    write_pod(out, process.size);
+    write_pod(out, process.arrival_time);
+    write_pod(out, process.start_time);
+    write_pod(out, process.processing_time);
+    write_pod(out, process.remaining_time);
+    write_pod(out, process.partition_number);
+    write_pod(out, process.state);
+    write_pod(out, process.io_freq);
+    write_pod(out, process.io_duration);
+    write_pod(out, process.priority);
+    write_pod(out, process.time_in_cpu);
+    write_pod(out, (bool) process.bursts);
+    if(process.bursts) {
+        write_pods(out, process.bursts->io_points);
+        write_pods(out, process.bursts->io_lengths);
+    }
+}
+
+//Bytes of a PCB record without its burst schedule
+const std::size_t PROCESS_RECORD_SIZE = 3 * sizeof(int) + 8 * sizeof(unsigned int) + sizeof(states) + sizeof(bool);
+
+bool read_process(std::istream &in, PCB &process) {
+    read_pod(in, process.PID);
+    read_pod(in, process.size);
+    read_pod(in, process.arrival_time);
+    read_pod(in, process.start_time);
+    read_pod(in, process.processing_time);
+    read_pod(in, process.remaining_time);
+    read_pod(in, process.partition_number);
+    read_pod(in, process.state);
+    read_pod(in, process.io_freq);
+    read_pod(in, process.io_duration);
+    read_pod(in, process.priority);
+    read_pod(in, process.time_in_cpu);
+    bool has_bursts = false;
+    read_pod(in, has_bursts);
+    process.bursts = nullptr;
+    if(has_bursts) {
+        burst_schedule schedule;
+        read_pods(in, schedule.io_points);
+        read_pods(in, schedule.io_lengths);
+        process.bursts = std::make_shared<const burst_schedule>(schedule);
+    }
+    return (bool) in;
+}
+
+void write_processes(std::ostream &out, const std::vector<PCB> &processes) {
+    write_pod(out, (std::uint32_t) processes.size());
+    for(const auto &process : processes) {
+        write_process(out, process);
+    }
+}
+
+bool read_processes(std::istream &in, std::vector<PCB> &processes) {
+    std::uint32_t count = 0;
+    if(!read_count(in, count, PROCESS_RECORD_SIZE)) {
+        return false;
+    }
+    processes.assign(count, PCB());
+    for(auto &process : processes) {
+        if(!read_process(in, process)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//The statistics of a process are written field by field, the struct has padding
+void write_stats(std::ostream &out, const process_stats &stats) {
+    write_pod(out, stats.arrived);
+    write_pod(out, stats.arrival);
+    write_pod(out, stats.first_run);
+    write_pod(out, stats.completion);
+    write_pod(out, stats.ready_since);
+    write_pod(out, stats.wait_time);
+    write_pod(out, stats.burst_start);
+    write_pod(out, stats.burst_length);
+    write_pod(out, stats.io_since);
+}
+
+bool read_stats(std::istream &in, process_stats &stats) {
+    read_pod(in, stats.arrived);
+    read_pod(in, stats.arrival);
+    read_pod(in, stats.first_run);
+    read_pod(in, stats.completion);
+    read_pod(in, stats.ready_since);
+    read_pod(in, stats.wait_time);
+    read_pod(in, stats.burst_start);
+    read_pod(in, stats.burst_length);
+    read_pod(in, stats.io_since);
+    return (bool) in;
+}
+
+const std::size_t STATS_RECORD_SIZE = sizeof(bool) + 6 * sizeof(unsigned int) + 2 * sizeof(int);
+
+void write_metrics(std::ostream &out, const sim_metrics &metrics) {
+    write_pod(out, (std::uint32_t) metrics.processes.size());
+    for(const auto &entry : metrics.processes) {
+        write_pod(out, entry.first);
+        write_stats(out, entry.second);
+    }
+    write_pods(out, metrics.recent_bursts);
+    write_pod(out, metrics.last_event);
+    write_pod(out, metrics.useful_time);
+    write_pod(out, metrics.overhead_time);
+    write_pod(out, metrics.io_operations);
+    write_pod(out, metrics.io_wait_time);
+    write_pod(out, metrics.swap_outs);
+    write_pod(out, metrics.swap_ins);
+    write_pod(out, metrics.swap_traffic);
+
+    write_pod(out, (std::uint32_t) metrics.io_devices.size());
+    for(const auto &device : metrics.io_devices) {
+        write_pod(out, device.busy_time);
+        write_pod(out, device.requests);
+        write_pod(out, (std::uint32_t) device.queue_histogram.size());
+        for(const auto &bucket : device.queue_histogram) {
+            write_pod(out, bucket.first);
+            write_pod(out, bucket.second);
+        }
+    }
+}
+
+bool read_metrics(std::istream &in, sim_metrics &metrics) {
+    std::uint32_t count = 0;
+    read_count(in, count, sizeof(int) + STATS_RECORD_SIZE);
+    for(std::uint32_t i = 0; i < count && in; i++) {
+        int PID;
+        read_pod(in, PID);
+        read_stats(in, metrics.processes[PID]);
+    }
+    read_pods(in, metrics.recent_bursts);
+    read_pod(in, metrics.last_event);
+    read_pod(in, metrics.useful_time);
+    read_pod(in, metrics.overhead_time);
+    read_pod(in, metrics.io_operations);
+    read_pod(in, metrics.io_wait_time);
+    read_pod(in, metrics.swap_outs);
+    read_pod(in, metrics.swap_ins);
+    read_pod(in, metrics.swap_traffic);
+
+    if(!read_count(in, count, 3 * sizeof(std::uint32_t))) {
+        return false;
+    }
+    metrics.io_devices.assign(count, io_device_stats());
+    for(auto &device : metrics.io_devices) {
+        std::uint32_t buckets = 0;
+        read_pod(in, device.busy_time);
+        read_pod(in, device.requests);
+        read_count(in, buckets, 2 * sizeof(unsigned int));
+        for(std::uint32_t i = 0; i < buckets && in; i++) {
+            unsigned int length, time;
+            read_pod(in, length);
+            read_pod(in, time);
+            device.queue_histogram[length] = time;
+        }
+    }
+    return (bool) in;
+}
+
+//------------------------------------RUN OPTIONS--------------------------------------------
+
+typedef std::vector<std::pair<std::string, std::string>> run_option_list;
+
+//Options that change the course of the run or what its tables record, as name and value
+run_option_list run_options(const sim_config &config) {
+    auto number = [](unsigned int value) {
+        return std::to_string(value);
+    };
+    std::string PIDs, transitions;
+    for(int PID : config.filter.PIDs) {
+        PIDs += (PIDs.empty() ? "" : ",") + std::to_string(PID);
+    }
+    for(const auto &pattern : config.filter.transitions) {
+        transitions += (transitions.empty() ? "" : ",") + std::to_string(pattern.old_state) + "->" + std::to_string(pattern.new_state);
+    }
+
+    run_option_list options = {
+        {"scheduler", config.policy},
+        {"--context-switch", number(config.context_switch_cost)},
+        {"--scheduler-cost", number(config.scheduler_cost)},
+        {"--scheduler-cost-per-ready", std::to_string(config.scheduler_cost_per_ready)},
+        {"--admission-cost", number(config.admission_cost)},
+        {"--io-devices", number(config.io_devices)},
+        {"--io-queue", config.io_priority_queue ? "priority" : "fifo"},
+        {"--swap", !config.swapping ? "off" : (config.swap_policy == LONGEST_BLOCKED ? "longest-blocked" : "lowest-priority")},
+        {"--swap-cost", number(config.swap_cost)},
+        {"--memory-status", config.memory_status ? "on" : "off"},
+        {"--memory-interval", number(config.memory_interval)},
+        {"--trace-pids", PIDs},
+        {"--trace-transitions", transitions},
+        {"--trace-window", number(config.filter.from_time) + ":" + number(config.filter.until_time)},
+        {"--trace-sample", number(config.filter.sample_every)},
+    };
+    // EP has no time quantum
+    if(config.policy != "EP") {
+        options.push_back({"--quantum", number(config.time_quantum)});
+        options.push_back({"--adaptive-quantum", config.adaptive_quantum ? "on" : "off"});
+    }
+    return options;
+}
+
+//Returns false (with an error naming the option) unless config runs with the options of the checkpoint
+bool same_run_options(const run_option_list &saved, const sim_config &config) {
+    run_option_list current = run_options(config);
+    for(const auto &option : saved) {
+        auto found = std::find_if(current.begin(), current.end(), [&](const auto &other) {
+            return other.first == option.first;
+        });
+        std::string value = (found == current.end()) ? "" : found->second;
+        if(value != option.second) {
+            std::cerr << "Error: the checkpoint was taken with " << option.first << " "
+                      << (option.second.empty() ? "none" : option.second) << ", this run has "
+                      << (value.empty() ? "none" : value) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_run_options(std::ostream &out, const run_option_list &options) {
+    write_pod(out, (std::uint32_t) options.size());
+    for(const auto &option : options) {
+        write_string(out, option.first);
+        write_string(out, option.second);
+    }
+}
+
+bool read_run_options(std::istream &in, run_option_list &options) {
+    std::uint32_t count = 0;
+    if(!read_count(in, count, 2 * sizeof(std::uint32_t))) {
+        return false;
+    }
+    options.assign(count, {});
+    for(auto &option : options) {
+        read_string(in, option.first);
+        read_string(in, option.second);
+    }
+    return (bool) in;
+}
+
+//------------------------------------CHECKPOINT IMAGE---------------------------------------
+
+//Writes the full simulation state, only processes that can still arrive are kept
+void write_state(std::ostream &out, const sim_state &state, const sim_config &config) {
+    write_pod(out, CHECKPOINT_MAGIC);
+    write_pod(out, CHECKPOINT_VERSION);
+    write_run_options(out, run_options(config));
+
+    std::vector<PCB> future_arrivals;
+    for(const auto &process : state.list_processes) {
+        if(process.arrival_time >= state.current_time) {
+            future_arrivals.push_back(process);
+        }
+    }
+    write_processes(out, future_arrivals);
+    write_processes(out, state.ready_queue);
+    write_processes(out, state.wait_queue);
+    write_processes(out, state.job_list);
+    write_process(out, state.running);
+    write_pod(out, state.current_time);
+    write_pod(out, state.overhead_pending);
+    write_pod(out, state.quantum_remaining);
+    write_pod(out, state.io_start_time);
+    write_pod(out, memory_paritions);
+
+    write_pod(out, state.recorder.output_position);
+    write_string(out, state.recorder.execution_status);
+    write_pod(out, state.recorder.memory_tracking);
+    write_pod(out, state.recorder.memory_interval);
+    write_pod(out, state.recorder.next_memory_sample);
+    write_pod(out, state.recorder.memory_position);
+    write_string(out, state.recorder.memory_status);
+    write_string(out, state.recorder.pending_memory_row);
+    write_pod(out, state.recorder.transitions);
+    write_pod(out, state.recorder.matched);
+    write_pod(out, state.recorder.recorded);
+    write_metrics(out, state.recorder.metrics);
+
+    write_pod(out, (std::uint32_t) state.io.devices.size());
+    for(const auto &device : state.io.devices) {
+        write_pod(out, device.PID);
+        write_pod(out, device.finish_time);
+        write_pods(out, device.queue);
+    }
+    write_pod(out, state.io.priority_queue);
+    write_pods(out, state.io.completed);
+
+    write_processes(out, state.swap.admission_queue);
+    write_processes(out, state.swap.suspended);
+    write_pod(out, (std::uint32_t) state.swap.loading.size());
+    for(const auto &transfer : state.swap.loading) {
+        write_process(out, transfer.process);
+        write_pod(out, transfer.ready_time);
+        write_pod(out, transfer.old_state);
+    }
+}
+
+//Reads a state written by write_state, returns false if the data is not a valid checkpoint
+bool read_state(std::istream &in, sim_state &state, run_option_list &options) {
+    std::uint32_t magic = 0, version = 0;
+    if(!read_pod(in, magic) || magic != CHECKPOINT_MAGIC || !read_pod(in, version) || version != CHECKPOINT_VERSION) {
+        return false;
+    }
+    state = sim_state();
+    read_run_options(in, options);
+
+    read_processes(in, state.list_processes);
+    read_processes(in, state.ready_queue);
+    read_processes(in, state.wait_queue);
+    read_processes(in, state.job_list);
+    read_process(in, state.running);
+    read_pod(in, state.current_time);
+    read_pod(in, state.overhead_pending);
+    read_pod(in, state.quantum_remaining);
+    read_pod(in, state.io_start_time);
+    read_pod(in, memory_paritions);
+
+    read_pod(in, state.recorder.output_position);
+    read_string(in, state.recorder.execution_status);
+    read_pod(in, state.recorder.memory_tracking);
+    read_pod(in, state.recorder.memory_interval);
+    read_pod(in, state.recorder.next_memory_sample);
+    read_pod(in, state.recorder.memory_position);
+    read_string(in, state.recorder.memory_status);
+    read_string(in, state.recorder.pending_memory_row);
+    read_pod(in, state.recorder.transitions);
+    read_pod(in, state.recorder.matched);
+    read_pod(in, state.recorder.recorded);
+    read_metrics(in, state.recorder.metrics);
+
+    std::uint32_t devices = 0;
+    if(!read_count(in, devices, sizeof(int) + 2 * sizeof(std::uint32_t))) {
+        return false;
+    }
+    state.io.devices.assign(devices, io_device());
+    for(auto &device : state.io.devices) {
+        read_pod(in, device.PID);
+        read_pod(in, device.finish_time);
+        read_pods(in, device.queue);
+    }
+    read_pod(in, state.io.priority_queue);
+    read_pods(in, state.io.completed);
+
+    read_processes(in, state.swap.admission_queue);
+    read_processes(in, state.swap.suspended);
+    std::uint32_t transfers = 0;
+    if(!read_count(in, transfers, PROCESS_RECORD_SIZE + sizeof(unsigned int) + sizeof(states))) {
+        return false;
+    }
+    state.swap.loading.assign(transfers, swap_transfer());
+    for(auto &transfer : state.swap.loading) {
+        read_process(in, transfer.process);
+        read_pod(in, transfer.ready_time);
+        read_pod(in, transfer.old_state);
+    }
+
+    return (bool) in;
+}
+
+//------------------------------------CHECKPOINT FILES---------------------------------------
+
+//Saves a checkpoint, the file is replaced atomically so an interruption never leaves a partial one
+bool save_checkpoint(sim_state &state, const sim_config &config) {
+    flush_output(state.recorder);
+    flush_memory_status(state.recorder);
+
+    std::string temp_file = config.checkpoint_file + ".tmp";
+    std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) {
+        std::cerr << "Error: Unable to write checkpoint " << temp_file << std::endl;
+        return false;
+    }
+    write_state(out, state, config);
+    out.close();
+
+    return std::rename(temp_file.c_str(), config.checkpoint_file.c_str()) == 0;
+}
+
+//Saves a checkpoint if one is due at the current time
+void checkpoint_if_due(sim_state &state, const sim_config &config) {
+    if(config.checkpoint_file.empty() || config.checkpoint_interval == 0) {
+        return;
+    }
+    if(state.current_time % config.checkpoint_interval == 0) {
+        save_checkpoint(state, config);
+    }
+}
+
+//Reads a checkpoint into state (and the partition table of the calling thread)
+bool read_checkpoint(sim_state &state, const std::string &file_name, run_option_list &options) {
+    std::ifstream in(file_name, std::ios::binary);
+    return in.is_open() && read_state(in, state, options);
+}
+
+//Loads the checkpoint to resume, refused if the run options differ from the ones it was taken with
+bool load_checkpoint(sim_state &state, const sim_config &config) {
+    run_option_list options;
+    if(!read_checkpoint(state, config.resume_file, options)) {
+        std::cerr << "Error: " << config.resume_file << " is not a valid checkpoint" << std::endl;
+        return false;
+    }
+    if(!same_run_options(options, config)) {
+        return false;
+    }
+    std::cout << "Resuming " << config.policy << " checkpoint at " << state.current_time << "ms" << std::endl;
+    return true;
+}
+
+//Prepares the file of a table streamed while the simulation runs. When resuming, the part written
+//after the checkpoint (position bytes) is discarded so the file continues exactly where it stopped.
+bool open_streamed_file(const std::string &file_name, std::uint64_t &position, bool resume) {
+    if(!resume) {
+        std::ofstream output_file(file_name, std::ios::binary | std::ios::trunc);
+        position = 0;
+        return output_file.is_open();
+    }
+
+    // Nothing written yet (e.g. a forked state), start a fresh file
+    if(position == 0) {
+        std::ofstream output_file(file_name, std::ios::binary | std::ios::trunc);
+        return output_file.is_open();
+    }
+
+    std::error_code error;
+    if(std::filesystem::file_size(file_name, error) < position || error) {
+        std::cerr << "Error: " << file_name << " is shorter than the checkpoint expects" << std::endl;
+        return false;
+    }
+    std::filesystem::resize_file(file_name, position, error);
+    return !error;
+}
+
+//Streams the execution table to the output file
+bool open_output(sim_recorder &recorder, const std::string &file_name, bool resume) {
+    recorder.output_file = file_name;
+    return open_streamed_file(file_name, recorder.output_position, resume);
+}
+
+//Streams the memory status table to its file, every checkpoint appends the rows logged since the last one
+bool open_memory_output(sim_recorder &recorder, const std::string &file_name, bool resume) {
+    recorder.memory_file = file_name;
+    return open_streamed_file(file_name, recorder.memory_position, resume);
+}
+
+#endif
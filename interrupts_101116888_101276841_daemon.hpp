@@ -0,0 +1,295 @@
+/**
+ * @file interrupts_101116888_101276841_daemon.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Service mode: a long-running simulation fed and queried with line commands
+ *
+ * Commands are read from stdin (--daemon) or from clients of a UNIX domain
+ * socket (--socket <path>, one client at a time, the simulation carries on
+ * across connections). Each command gets one reply:
+ *   OK [value]              for commands with a short answer
+ *   OK <n> + n lines        for tables
+ *   ERROR <message>
+ * The execution table is appended to the output file after every advance.
+ */
+
+#ifndef INTERRUPTS_DAEMON_HPP_
+#define INTERRUPTS_DAEMON_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_checkpoint.hpp"
+
+#include<csignal>
+#include<cstring>
+#include<unistd.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+
+//Longest run of a single advance or until (ms), the service answers nobody while it runs
+const unsigned int DAEMON_MAX_STEP = 100000;
+
+const char* DAEMON_HELP =
+    "<PID>, <size>, <arrival>, <processing>, <io_freq>, <io_duration>   submit a process\n"
+    "advance <ms>      run the simulation for ms (at most 100000)\n"
+    "until <time>      run the simulation until the clock reaches time (at most 100000 ms ahead)\n"
+    "time              current simulated time\n"
+    "ready             ready queue length\n"
+    "running           PID on the CPU (-1 if idle)\n"
+    "memory            partition occupancy\n"
+    "metrics           metrics of the run so far\n"
+    "processes         PCB table of the admitted processes\n"
+    "quit              end this session\n"
+    "shutdown          stop the service\n";
+
+//Reads lines from a file descriptor
+struct line_reader {
+    int             fd;
+    std::string     buffer;
+
+    bool next(std::string &line) {
+        while(true) {
+            std::size_t end = buffer.find('\n');
+            if(end != std::string::npos) {
+                line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if(!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                return true;
+            }
+            char chunk[4096];
+            ssize_t count = read(fd, chunk, sizeof(chunk));
+            if(count <= 0) {
+                // Last line without a newline
+                if(buffer.empty()) {
+                    return false;
+                }
+                line.swap(buffer);
+                buffer.clear();
+                return true;
+            }
+            buffer.append(chunk, count);
+        }
+    }
+};
+
+bool write_all(int fd, const std::string &data) {
+    std::size_t written = 0;
+    while(written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if(count <= 0) {
+            return false;
+        }
+        written += count;
+    }
+    return true;
+}
+
+//Reply made of a table: "OK <lines>" followed by the lines
+std::string table_reply(const std::string &table) {
+    return "OK " + std::to_string(std::count(table.begin(), table.end(), '\n')) + "\n" + table;
+}
+
+//Outcome of a command for the session loop
+enum daemon_actions {
+    KEEP_SERVING,
+    END_SESSION,
+    STOP_SERVICE
+};
+
+//Runs the simulation up to (excluding) end_time and writes the new part of the execution table
+template<typename Tick>
+void advance_until(Tick tick, sim_state &state, const sim_config &config, unsigned int end_time) {
+    track_memory(&state.recorder, &state.current_time);
+    while(state.current_time < end_time) {
+        tick(state, config);
+        finish_tick(state);
+    }
+    track_memory(nullptr, nullptr);
+
+    // Processes that have arrived are not needed in the arrival list anymore
+    forget_arrivals(state);
+
+    flush_output(state.recorder);
+}
+
+//Returns true if a process with this PID was submitted before (pending, admitted or seen by the metrics)
+bool known_PID(const sim_state &state, int PID) {
+    auto same = [&](const PCB &process) {
+        return process.PID == PID;
+    };
+    return std::any_of(state.list_processes.begin(), state.list_processes.end(), same)
+        || std::any_of(state.job_list.begin(), state.job_list.end(), same)
+        || state.recorder.metrics.processes.count(PID) > 0;
+}
+
+//Executes one command, reply receives the answer
+template<typename Tick>
+daemon_actions run_command(Tick tick, sim_state &state, const sim_config &config, const std::string &command, std::string &reply) {
+    auto words = split_delim(command, " ");
+    const std::string &name = words[0];
+    unsigned int value = 0;
+    bool valid_value = (words.size() == 2) && parse_unsigned(words[1], value);
+
+    if(command.empty()) {
+        reply = "ERROR empty command\n";
+    } else if(command.find(',') != std::string::npos) {
+        auto input_tokens = split_delim(command, ", ");
+        PCB process;
+        try {
+            if(input_tokens.size() != 6 && input_tokens.size() != 7) {
+                throw std::invalid_argument("fields");
+            }
+            process = add_process(input_tokens);
+        } catch(const std::exception &) {
+            reply = "ERROR expected PID, size, arrival, processing, io_freq, io_duration\n";
+            return KEEP_SERVING;
+        }
+        if(process.arrival_time < state.current_time) {
+            reply = "ERROR arrival " + std::to_string(process.arrival_time) + " is before the current time "
+                  + std::to_string(state.current_time) + "\n";
+            return KEEP_SERVING;
+        }
+        if(known_PID(state, process.PID)) {
+            reply = "ERROR PID " + std::to_string(process.PID) + " was already submitted\n";
+            return KEEP_SERVING;
+        }
+        state.list_processes.push_back(process);
+        reply = "OK\n";
+    } else if((name == "advance" || name == "until") && !valid_value) {
+        reply = "ERROR expected " + name + (name == "advance" ? " <ms>" : " <time>") + "\n";
+    } else if(name == "advance" && value > UINT_MAX - state.current_time) {
+        reply = "ERROR advance " + std::to_string(value) + " goes past the largest time\n";
+    } else if(name == "advance" && value > DAEMON_MAX_STEP) {
+        reply = "ERROR advance " + std::to_string(value) + " is longer than " + std::to_string(DAEMON_MAX_STEP) + " ms\n";
+    } else if(name == "advance") {
+        advance_until(tick, state, config, state.current_time + value);
+        reply = "OK " + std::to_string(state.current_time) + "\n";
+    } else if(name == "until" && value < state.current_time) {
+        reply = "ERROR until " + std::to_string(value) + " is before the current time "
+              + std::to_string(state.current_time) + "\n";
+    } else if(name == "until" && value - state.current_time > DAEMON_MAX_STEP) {
+        reply = "ERROR until " + std::to_string(value) + " is more than " + std::to_string(DAEMON_MAX_STEP)
+              + " ms after the current time " + std::to_string(state.current_time) + "\n";
+    } else if(name == "until") {
+        advance_until(tick, state, config, value);
+        reply = "OK " + std::to_string(state.current_time) + "\n";
+    } else if(name == "time") {
+        reply = "OK " + std::to_string(state.current_time) + "\n";
+    } else if(name == "ready") {
+        reply = "OK " + std::to_string(state.ready_queue.size()) + "\n";
+    } else if(name == "running") {
+        reply = "OK " + std::to_string(state.running.PID) + "\n";
+    } else if(name == "memory") {
+        reply = table_reply(print_memory_header() + print_memory_status(state.current_time)
+                            + "+" + std::string(68 + 6 * std::size(memory_paritions), '-') + "+\n");
+    } else if(name == "metrics") {
+        reply = table_reply(print_metrics(state.recorder.metrics));
+    } else if(name == "processes") {
+        // The running PCB is more recent than its copy in the job list
+        std::vector<PCB> processes = state.job_list;
+        if(state.running.PID != -1) {
+            sync_queue(processes, state.running);
+        }
+        reply = table_reply(print_PCB(processes));
+    } else if(name == "help") {
+        reply = table_reply(DAEMON_HELP);
+    } else if(name == "quit") {
+        reply = "OK\n";
+        return END_SESSION;
+    } else if(name == "shutdown") {
+        reply = "OK\n";
+        return STOP_SERVICE;
+    } else {
+        reply = "ERROR unknown command: " + name + "\n";
+    }
+    return KEEP_SERVING;
+}
+
+//Serves commands from one client until it quits or disconnects
+template<typename Tick>
+daemon_actions serve_session(Tick tick, sim_state &state, const sim_config &config, int in_fd, int out_fd) {
+    line_reader reader{in_fd, ""};
+    std::string command, reply;
+    while(reader.next(command)) {
+        daemon_actions action = run_command(tick, state, config, command, reply);
+        if(!write_all(out_fd, reply) || action != KEEP_SERVING) {
+            return action;
+        }
+    }
+    return END_SESSION;
+}
+
+int listen_unix_socket(const std::string &path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: socket path too long: " << path << std::endl;
+        return -1;
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd == -1) {
+        std::cerr << "Error: Unable to create socket" << std::endl;
+        return -1;
+    }
+    unlink(path.c_str());
+    if(bind(fd, (sockaddr*) &address, sizeof(address)) == -1 || listen(fd, 8) == -1) {
+        std::cerr << "Error: Unable to listen on " << path << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//Runs the simulation as a service until it is shut down (or stdin ends)
+template<typename Tick>
+int serve_simulation(Tick tick, sim_state &state, const sim_config &config, const std::string &output_file) {
+    if(!open_output(state.recorder, output_file, false)) {
+        std::cerr << "Error: Unable to open output file: " << output_file << std::endl;
+        return -1;
+    }
+
+    bool failed = false;
+    if(config.socket_path.empty()) {
+        std::cout << "READY " << config.policy << std::endl;
+        serve_session(tick, state, config, STDIN_FILENO, STDOUT_FILENO);
+    } else {
+        int server = listen_unix_socket(config.socket_path);
+        if(server == -1) {
+            return -1;
+        }
+        std::signal(SIGPIPE, SIG_IGN);     // A client leaving early must not stop the service
+        std::cout << "READY " << config.policy << " on " << config.socket_path << std::endl;
+
+        daemon_actions action = KEEP_SERVING;
+        while(action != STOP_SERVICE) {
+            int client = accept(server, nullptr, nullptr);
+            if(client == -1 && errno == EINTR) {
+                continue;
+            }
+            if(client == -1) {
+                // A persistent error (e.g. EMFILE) would fail again at once, stop instead of spinning
+                std::cerr << "Error: accept failed on " << config.socket_path << ": " << std::strerror(errno) << std::endl;
+                failed = true;
+                break;
+            }
+            action = serve_session(tick, state, config, client, client);
+            close(client);
+        }
+        close(server);
+        unlink(config.socket_path.c_str());
+    }
+
+    // Close the output tables
+    close_execution_table(state.recorder);
+    flush_output(state.recorder);
+    close_memory_status(state.recorder);
+    if(config.memory_status) {
+        write_output(state.recorder.memory_status, ("memory_status_" + config.policy + ".txt").c_str());
+    }
+    return failed ? -1 : 0;
+}
+
+#endif
@@ -0,0 +1,301 @@
+/**
+ * @file interrupts_101116888_101276841_fork.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief What-if forking of a running simulation
+ *
+ * The simulation runs normally up to the fork time, then its state is copied
+ * and each copy continues under a different quantum or scheduler, in parallel.
+ * Branches of the current scheduler run as threads of this process, branches of
+ * another scheduler resume a checkpoint of the forked state in the sibling
+ * binary (bin/interrupts_<policy>). All branches are compared side by side.
+ */
+
+#ifndef INTERRUPTS_FORK_HPP_
+#define INTERRUPTS_FORK_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_checkpoint.hpp"
+
+#include<filesystem>
+#include<iterator>
+#include<cstring>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/wait.h>
+
+//One way of continuing the forked simulation
+struct fork_branch {
+    std::string     policy;         // Scheduler to continue with
+    int             quantum = -1;   // Quantum override, -1 = keep the configured one
+    std::string     name;
+    bool            ok = false;
+    std::string     error;          // Why the branch failed
+    sim_metrics     metrics;
+};
+
+//Parses "[POLICY][@QUANTUM],..." e.g. "RR@50,EP,@200"
+bool parse_fork_branches(const std::string &spec, const std::string &own_policy, std::vector<fork_branch> &branches) {
+    for(const auto &item : split_delim(spec, ",")) {
+        fork_branch branch;
+        auto parts = split_delim(item, "@");
+        branch.policy = parts[0].empty() ? own_policy : parts[0];
+        if(branch.policy != "EP" && branch.policy != "RR" && branch.policy != "EP_RR") {
+            std::cerr << "Unknown scheduler in --fork: " << branch.policy << std::endl;
+            return false;
+        }
+        if(parts.size() > 1 && branch.policy == "EP") {
+            std::cerr << "Error: EP has no time quantum, in --fork: " << item << std::endl;
+            return false;
+        }
+        if(parts.size() > 1) {
+            unsigned int quantum = 0;
+            if(parts.size() > 2 || !parse_unsigned(parts[1], quantum) || quantum < 1 || quantum > INT_MAX) {
+                std::cerr << "Expected a whole quantum of at least 1, in --fork: " << item << std::endl;
+                return false;
+            }
+            branch.quantum = (int) quantum;
+        }
+        branch.name = branch.policy + (branch.quantum != -1 ? "@" + std::to_string(branch.quantum) : "");
+        branches.push_back(branch);
+    }
+    return !branches.empty();
+}
+
+//Command line options the sibling binaries inherit: everything but the fork, tuning and checkpoint
+//options and the ones that write output files or change the mode of the run
+std::vector<std::string> forwarded_options(int argc, char** argv) {
+    const std::vector<std::string> dropped = {"--fork", "--fork-at", "--checkpoint", "--checkpoint-interval", "--resume",
+                                              "--tune", "--tune-range", "--binary-trace", "--snapshot-every",
+                                              "--chrome-trace", "--memory-interval", "--trace-pids", "--trace-transitions",
+                                              "--trace-window", "--trace-sample", "--trace-last", "--socket",
+                                              "--replicas", "--seed"};
+    const std::vector<std::string> dropped_flags = {"--memory-status", "--no-text-trace", "--daemon", "--pipeline"};
+    std::vector<std::string> options;
+    for(int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if(std::find(dropped.begin(), dropped.end(), option) != dropped.end()) {
+            i++;    // Skip its value too
+            continue;
+        }
+        if(std::find(dropped_flags.begin(), dropped_flags.end(), option) != dropped_flags.end()) {
+            continue;
+        }
+        options.push_back(option);
+    }
+    return options;
+}
+
+//Continues a copy of the forked state in the sibling binary of another scheduler.
+//The sibling runs in its own directory without an execution table, so it overwrites none of the
+//user's files nor those of the other branches. Its final state comes back through a checkpoint.
+//It is started with an argument vector, no shell sees the file names or the options.
+void run_sibling_branch(fork_branch &branch, const std::string &fork_file, const std::string &directory,
+                        const std::string &program, const std::string &input_file, const std::vector<std::string> &options) {
+    std::string binaries = program.substr(0, program.find_last_of('/') + 1);
+    if(!binaries.empty()) {
+        binaries = std::filesystem::absolute(binaries).string();
+    }
+    std::string binary = binaries + "interrupts_" + branch.policy;
+    std::string result_file = directory + "/result.ckpt";
+
+    std::vector<std::string> arguments = {binary, std::filesystem::absolute(input_file).string(), "--no-text-trace"};
+    for(std::size_t i = 0; i < options.size(); i++) {
+        // EP refuses the quantum options
+        if(branch.policy == "EP" && (options[i] == "--quantum" || options[i] == "--adaptive-quantum")) {
+            i += (options[i] == "--quantum");
+            continue;
+        }
+        arguments.push_back(options[i]);
+    }
+    arguments.insert(arguments.end(), {"--resume", fork_file, "--checkpoint", result_file});
+    if(branch.quantum != -1) {
+        arguments.insert(arguments.end(), {"--quantum", std::to_string(branch.quantum)});
+    }
+    std::vector<char*> argv;
+    for(auto &argument : arguments) {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    // Only async-signal-safe calls between fork and exec, the other branches are threads of this process
+    pid_t child = fork();
+    if(child == -1) {
+        branch.error = "cannot start " + binary + ": " + std::strerror(errno);
+        return;
+    }
+    if(child == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if(chdir(directory.c_str()) == -1 || null_fd == -1 || dup2(null_fd, STDOUT_FILENO) == -1) {
+            _exit(127);
+        }
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    while(waitpid(child, &status, 0) == -1) {
+        if(errno != EINTR) {
+            branch.error = "lost " + binary + ": " + std::strerror(errno);
+            return;
+        }
+    }
+    if(WIFSIGNALED(status)) {
+        branch.error = binary + " was killed by signal " + std::to_string(WTERMSIG(status));
+        return;
+    }
+    if(WEXITSTATUS(status) == 127) {
+        branch.error = "cannot run " + binary;
+        return;
+    }
+    if(WEXITSTATUS(status) != 0) {
+        branch.error = binary + " exited with status " + std::to_string(WEXITSTATUS(status));
+        return;
+    }
+    sim_state result;
+    run_option_list result_options;
+    branch.ok = read_checkpoint(result, result_file, result_options);
+    branch.metrics = result.recorder.metrics;
+    if(!branch.ok) {
+        branch.error = binary + " left no final checkpoint";
+    }
+}
+
+//Runs the simulation up to fork_time, then continues it under every branch in parallel.
+//A "baseline" branch continuing without any change is always included.
+template<typename Tick, typename Simulator>
+std::vector<fork_branch> fork_simulation(Tick tick, Simulator simulate, sim_state &state, const sim_config &config,
+                                         unsigned int fork_time, std::vector<fork_branch> branches,
+                                         const std::string &program, const std::string &input_file,
+                                         const std::vector<std::string> &options) {
+    while(!simulation_done(state) && state.current_time < fork_time && state.current_time <= 100000) {
+        tick(state, config);
+    }
+
+    // Every scheduler must find the I/O start of waiting processes where it expects it:
+    // in time_in_cpu for the RR based ones, in io_start_time (last I/O started) for EP
+    for(auto &process : state.wait_queue) {
+        process.time_in_cpu = state.recorder.metrics.processes[process.PID].io_since;
+        state.io_start_time = std::max(state.io_start_time, process.time_in_cpu);
+    }
+
+    // Compact copy of the state at the fork, the transitions before it are not needed by the branches
+    state.recorder.execution_status.clear();
+    state.recorder.last_rows.clear();
+    state.recorder.next_row = 0;
+    state.recorder.sinks.clear();
+    sim_state snapshot = state;
+    memory_partition partitions[std::size(memory_paritions)];
+    std::copy(std::begin(memory_paritions), std::end(memory_paritions), partitions);
+
+    fork_branch baseline;
+    baseline.policy = config.policy;
+    baseline.name = "baseline";
+    branches.insert(branches.begin(), baseline);
+
+    sim_config branch_config = config;
+    branch_config.checkpoint_file.clear();
+    branch_config.resume_file.clear();
+
+    // Other schedulers pick the forked state up from a checkpoint, in a scratch directory removed once all branches are over.
+    // Each sibling gets its own, taken with the options it runs with (its scheduler and quantum, no tables),
+    // written here as the partition table is the one of this thread
+    std::string directory = (std::filesystem::temp_directory_path()
+                          / ("fork_" + std::to_string(getpid()) + "_" + std::to_string(snapshot.current_time))).string();
+    std::error_code error;
+    for(std::size_t i = 0; i < branches.size(); i++) {
+        if(branches[i].policy == config.policy) {
+            continue;
+        }
+        std::string branch_directory = directory + "/" + std::to_string(i);
+        std::filesystem::create_directories(branch_directory, error);
+        sim_config sibling_config = branch_config;
+        sibling_config.policy = branches[i].policy;
+        sibling_config.checkpoint_file = branch_directory + "/fork.ckpt";
+        if(branches[i].quantum != -1) {
+            sibling_config.time_quantum = branches[i].quantum;
+        }
+        sibling_config.memory_status = false;
+        sibling_config.memory_interval = 0;
+        sibling_config.filter = trace_filter();
+        sim_state sibling_state = snapshot;
+        sibling_state.recorder.output_file.clear();
+        sibling_state.recorder.output_position = 0;
+        sibling_state.recorder.memory_tracking = false;
+        sibling_state.recorder.memory_file.clear();
+        sibling_state.recorder.memory_position = 0;
+        sibling_state.recorder.memory_status.clear();
+        save_checkpoint(sibling_state, sibling_config);
+    }
+
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < branches.size(); i++) {
+        threads.emplace_back([&, i]() {
+            fork_branch &branch = branches[i];
+            if(branch.policy != config.policy) {
+                std::string branch_directory = directory + "/" + std::to_string(i);
+                run_sibling_branch(branch, branch_directory + "/fork.ckpt", branch_directory, program, input_file, options);
+                return;
+            }
+
+            // Each thread has its own partition table, start it from the forked one
+            std::copy(std::begin(partitions), std::end(partitions), memory_paritions);
+            sim_state branch_state = snapshot;
+            sim_config run_config = branch_config;
+            if(branch.quantum != -1) {
+                run_config.time_quantum = branch.quantum;
+            }
+            auto [exec, metrics, memory] = simulate(branch_state, run_config);
+            branch.metrics = metrics;
+            branch.ok = true;
+        });
+    }
+    for(auto &thread : threads) {
+        thread.join();
+    }
+    std::filesystem::remove_all(directory, error);
+    for(const auto &branch : branches) {
+        if(!branch.ok) {
+            std::cerr << "Error: branch " << branch.name << " failed: " << branch.error << std::endl;
+        }
+    }
+
+    return branches;
+}
+
+std::string print_fork_comparison(const std::vector<fork_branch> &branches, unsigned int fork_time) {
+    const int tableWidth = 92;
+    std::stringstream buffer;
+
+    buffer << "What-if comparison, forked at " << fork_time << "ms" << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+    buffer << "|" << std::setfill(' ')
+           << std::setw(12) << "Branch" << std::setw(2) << "|"
+           << std::setw(10) << "Completed" << std::setw(2) << "|"
+           << std::setw(11) << "Turnaround" << std::setw(2) << "|"
+           << std::setw(9) << "Response" << std::setw(2) << "|"
+           << std::setw(13) << "p99 Response" << std::setw(2) << "|"
+           << std::setw(9) << "Wait" << std::setw(2) << "|"
+           << std::setw(12) << "Throughput" << std::setw(2) << "|" << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    for(const auto &branch : branches) {
+        buffer << "|" << std::setfill(' ') << std::setw(12) << branch.name << std::setw(2) << "|";
+        if(!branch.ok) {
+            buffer << std::setw(tableWidth - 14) << "branch failed" << "|" << std::endl;
+            continue;
+        }
+        metrics_summary summary = summarize(branch.metrics);
+        buffer << std::fixed << std::setprecision(2)
+               << std::setw(10) << summary.completed << std::setw(2) << "|"
+               << std::setw(11) << summary.mean_turnaround << std::setw(2) << "|"
+               << std::setw(9) << summary.mean_response << std::setw(2) << "|"
+               << std::setw(13) << summary.p99_response << std::setw(2) << "|"
+               << std::setw(9) << summary.mean_wait << std::setw(2) << "|"
+               << std::setw(12) << summary.throughput << std::setw(2) << "|" << std::endl;
+    }
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+#endif
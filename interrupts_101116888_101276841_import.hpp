@@ -0,0 +1,612 @@
+/**
+ * @file interrupts_101116888_101276841_import.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Import of recorded Linux scheduler traces as simulator input
+ *
+ * Two formats are read, line by line, so traces of any length stream through:
+ *   perf   text output of `perf sched script` (sched_switch, sched_wakeup(_new),
+ *          sched_process_fork and sched_process_exit events)
+ *   proc   successive /proc/<pid>/sched dumps concatenated in one file
+ * Every task becomes one input line whose bursts field lists its CPU bursts and
+ * I/O blocks ("cpu/io cpu/io ... cpu", see add_burst_schedule), in simulated ms.
+ *
+ * perf: a task runs between its switch in and switch out. Switched out runnable
+ * (R) it was preempted and its burst goes on; switched out in any other state it
+ * blocks until its wakeup, which ends the I/O block. Only the tasks in progress
+ * are held in memory, a task's line is emitted when it exits.
+ * proc: between two dumps of a task the CPU time and the voluntary switches
+ * grow; the interval becomes that many equal bursts, separated by equal shares
+ * of the sleep time (or of the time not spent on the CPU without schedstats).
+ * The dumps are taken in rounds (every live task once per round, a task dumped
+ * twice starts the next round); a task missing from a round has exited.
+ *
+ * Besides the lines, the importer reports how far the import has settled: no
+ * task emitted later arrives before that time. run_import_simulation uses it to
+ * simulate while the trace is read instead of collecting every task first.
+ */
+
+#ifndef INTERRUPTS_IMPORT_HPP_
+#define INTERRUPTS_IMPORT_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+
+#include<set>
+
+//Settings of an import
+struct import_options {
+    unsigned int    tick_us = 1000;     // Microseconds of the trace per simulated ms
+    unsigned int    size = 1;           // Memory size (and EP priority) given to every task
+    std::ostream    *map = nullptr;     // Receives "PID <TAB> Linux PID <TAB> command" for every task, optional
+};
+
+//A task being reconstructed from the trace
+struct imported_task {
+    int                     PID;                // Simulator PID, by order of first appearance
+    int                     linux_PID;
+    std::string             command;
+    std::int64_t            first_seen = 0;     // Times in microseconds of the trace
+    bool                    running = false;
+    std::int64_t            running_since = 0;
+    bool                    blocked = false;
+    std::int64_t            blocked_since = 0;
+    bool                    woken = false;
+    std::int64_t            woken_at = 0;
+    bool                    exiting = false;
+    std::int64_t            burst = 0;          // CPU time of the burst in progress
+    std::vector<std::pair<std::int64_t, std::int64_t>> bursts;   // (CPU, I/O) of the completed bursts
+};
+
+//Rounds a trace duration to simulated ms
+unsigned int to_ticks(std::int64_t microseconds, const import_options &options) {
+    return (unsigned int) ((std::max<std::int64_t>(0, microseconds) + options.tick_us / 2) / options.tick_us);
+}
+
+//Simulated ms that a trace time at least this far from the start can not round below
+unsigned int settled_ticks(std::int64_t microseconds, const import_options &options) {
+    return (unsigned int) (std::max<std::int64_t>(0, microseconds) / options.tick_us);
+}
+
+//Input line of a finished task. Bursts too short for a simulated ms are merged into their neighbours:
+//a CPU burst rounding to 0 lengthens the previous I/O block, an I/O block rounding to 0 joins two bursts.
+std::string print_imported_task(const imported_task &task, std::int64_t origin, const import_options &options) {
+    std::vector<std::pair<unsigned int, unsigned int>> bursts;
+    unsigned int carried_cpu = 0;
+    for(const auto &burst : task.bursts) {
+        unsigned int cpu = to_ticks(burst.first, options) + carried_cpu;
+        unsigned int io = to_ticks(burst.second, options);
+        carried_cpu = 0;
+        if(cpu == 0) {
+            if(!bursts.empty()) {
+                bursts.back().second += io;
+            }
+            continue;
+        }
+        if(io == 0) {
+            carried_cpu = cpu;
+            continue;
+        }
+        bursts.push_back({cpu, io});
+    }
+    unsigned int last = to_ticks(task.burst, options) + carried_cpu;
+    if(last == 0 && !bursts.empty()) {
+        // The I/O block before the end is the last thing the task did, the simulation stops at its last burst
+        last = bursts.back().first;
+        bursts.pop_back();
+    }
+    last = std::max(1u, last);
+
+    std::stringstream fields, burst_list;
+    unsigned int processing_time = last;
+    for(const auto &burst : bursts) {
+        burst_list << burst.first << "/" << burst.second << " ";
+        processing_time += burst.first;
+    }
+    burst_list << last;
+
+    fields << task.PID << ", " << options.size << ", " << to_ticks(task.first_seen - origin, options) << ", "
+           << processing_time << ", " << (bursts.empty() ? 0 : bursts[0].first) << ", "
+           << (bursts.empty() ? 0 : bursts[0].second) << ", " << burst_list.str();
+    return fields.str();
+}
+
+//------------------------------------PERF SCHED---------------------------------------------
+
+//Value of " key=value" in an event line, empty if absent
+std::string event_field(const std::string &line, const std::string &key) {
+    std::size_t start = line.find(" " + key + "=");
+    if(start == std::string::npos) {
+        return "";
+    }
+    start += key.size() + 2;
+    std::size_t end = line.find(' ', start);
+    return line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+//PID of a "comm:pid" task in the compact perf format, -1 if the text is not one
+int compact_task_PID(const std::string &task) {
+    std::size_t colon = task.find_last_of(':');
+    if(colon == std::string::npos || colon + 1 == task.size()) {
+        return -1;
+    }
+    try {
+        return std::stoi(task.substr(colon + 1));
+    } catch(const std::exception &) {
+        return -1;
+    }
+}
+
+//One event of `perf sched script`
+struct sched_event {
+    std::string     name;               // sched_switch, sched_wakeup, ...
+    std::int64_t    time = 0;           // Microseconds
+    int             PID = -1;           // Task switched out, woken, created or exiting
+    std::string     command;
+    std::string     prev_state;         // sched_switch only
+    int             next_PID = -1;      // sched_switch only
+    std::string     next_command;
+};
+
+//Parses one line of `perf sched script`, returns false for lines that are not scheduler events
+bool parse_sched_event(const std::string &line, sched_event &event) {
+    std::size_t name_start = line.find("sched:sched_");
+    if(name_start == std::string::npos) {
+        return false;
+    }
+    std::size_t name_end = line.find(':', name_start + 6);
+    if(name_end == std::string::npos) {
+        return false;
+    }
+    event.name = line.substr(name_start + 6, name_end - name_start - 6);
+
+    // Timestamp in seconds, the token before the event name ("1234.567890:")
+    std::size_t time_end = line.find_last_not_of(" :", name_start - 1);
+    std::size_t time_start = line.find_last_of(' ', time_end);
+    time_start = (time_start == std::string::npos) ? 0 : time_start + 1;
+    try {
+        event.time = std::llround(std::stod(line.substr(time_start, time_end - time_start + 1)) * 1e6);
+    } catch(const std::exception &) {
+        return false;
+    }
+
+    std::string details = line.substr(name_end + 1);
+    if(event.name == "sched_switch") {
+        if(details.find(" prev_pid=") != std::string::npos) {
+            event.PID = std::atoi(event_field(details, "prev_pid").c_str());
+            event.command = event_field(details, "prev_comm");
+            event.prev_state = event_field(details, "prev_state");
+            event.next_PID = std::atoi(event_field(details, "next_pid").c_str());
+            event.next_command = event_field(details, "next_comm");
+        } else {
+            // Compact format: "prev_comm:prev_pid [prio] state ==> next_comm:next_pid [prio]"
+            std::size_t arrow = details.find("==>");
+            if(arrow == std::string::npos) {
+                return false;
+            }
+            std::stringstream previous(details.substr(0, arrow)), next(details.substr(arrow + 3));
+            std::string priority;
+            previous >> event.command >> priority >> event.prev_state;
+            next >> event.next_command;
+            event.PID = compact_task_PID(event.command);
+            event.next_PID = compact_task_PID(event.next_command);
+            event.command = event.command.substr(0, event.command.find_last_of(':'));
+            event.next_command = event.next_command.substr(0, event.next_command.find_last_of(':'));
+        }
+        return event.PID != -1 && event.next_PID != -1;
+    }
+
+    if(event.name == "sched_process_fork") {
+        event.PID = std::atoi(event_field(details, "child_pid").c_str());
+        event.command = event_field(details, "child_comm");
+    } else if(details.find(" pid=") != std::string::npos) {
+        event.PID = std::atoi(event_field(details, "pid").c_str());
+        event.command = event_field(details, "comm");
+    } else {
+        std::stringstream fields(details);
+        fields >> event.command;
+        event.PID = compact_task_PID(event.command);
+        event.command = event.command.substr(0, event.command.find_last_of(':'));
+    }
+    return event.PID != -1;
+}
+
+//Streams a `perf sched script` trace, emit receives the input line of every task,
+//settled the simulated time before which every task has been emitted
+template<typename Emit, typename Settled>
+void import_perf_sched(std::istream &in, const import_options &options, Emit emit, Settled settled) {
+    std::map<int, imported_task> tasks;     // In progress, by Linux PID
+    std::set<std::pair<std::int64_t, int>> first_seen;  // (first seen, Linux PID) of the tasks in progress
+    int next_PID = 1;
+    bool started = false;
+    std::int64_t origin = 0;
+    std::int64_t last_time = 0;
+
+    auto task_of = [&](int linux_PID, const std::string &command, std::int64_t time) -> imported_task & {
+        auto found = tasks.find(linux_PID);
+        if(found != tasks.end()) {
+            return found->second;
+        }
+        imported_task &task = tasks[linux_PID];
+        task.PID = next_PID++;
+        task.linux_PID = linux_PID;
+        task.command = command;
+        task.first_seen = time;
+        first_seen.insert({time, linux_PID});
+        if(options.map != nullptr) {
+            *options.map << task.PID << "\t" << linux_PID << "\t" << command << std::endl;
+        }
+        return task;
+    };
+    auto finish = [&](int linux_PID) {
+        auto found = tasks.find(linux_PID);
+        emit(print_imported_task(found->second, origin, options));
+        first_seen.erase({found->second.first_seen, linux_PID});
+        tasks.erase(found);
+    };
+
+    std::string line;
+    while(std::getline(in, line)) {
+        sched_event event;
+        if(!parse_sched_event(line, event)) {
+            continue;
+        }
+        if(!started) {
+            origin = event.time;
+            started = true;
+        }
+        last_time = event.time;
+        bool idle = (event.PID == 0);   // The idle task of each CPU is not a process
+
+        if(event.name == "sched_switch") {
+            if(!idle) {
+                imported_task &task = task_of(event.PID, event.command, event.time);
+                if(task.running) {
+                    task.burst += event.time - task.running_since;
+                    task.running = false;
+                }
+                char state = event.prev_state.empty() ? 'R' : event.prev_state[0];
+                if(task.exiting || state == 'X' || state == 'Z') {
+                    finish(event.PID);
+                } else if(state != 'R') {
+                    task.blocked = true;
+                    task.blocked_since = event.time;
+                    task.woken = false;
+                }
+            }
+            if(event.next_PID != 0) {
+                imported_task &task = task_of(event.next_PID, event.next_command, event.time);
+                if(task.blocked) {
+                    std::int64_t io_end = task.woken ? task.woken_at : event.time;
+                    task.bursts.push_back({task.burst, io_end - task.blocked_since});
+                    task.burst = 0;
+                    task.blocked = false;
+                }
+                task.running = true;
+                task.running_since = event.time;
+            }
+        } else if(idle) {
+            continue;
+        } else if(event.name == "sched_wakeup" || event.name == "sched_waking") {
+            imported_task &task = task_of(event.PID, event.command, event.time);
+            if(task.blocked && !task.woken) {
+                task.woken = true;
+                task.woken_at = event.time;
+            }
+        } else if(event.name == "sched_wakeup_new" || event.name == "sched_process_fork") {
+            task_of(event.PID, event.command, event.time);
+        } else if(event.name == "sched_process_exit") {
+            auto found = tasks.find(event.PID);
+            if(found != tasks.end()) {
+                found->second.exiting = true;
+            }
+        }
+
+        // The tasks still to come were first seen now or later, the ones in progress when they were
+        std::int64_t earliest = first_seen.empty() ? event.time : std::min(event.time, first_seen.begin()->first);
+        settled(settled_ticks(earliest - origin, options));
+    }
+
+    // Tasks still alive at the end of the trace end with the CPU time they had
+    while(!tasks.empty()) {
+        imported_task &task = tasks.begin()->second;
+        if(task.running) {
+            task.burst += last_time - task.running_since;
+        }
+        finish(tasks.begin()->first);
+    }
+}
+
+//------------------------------------/proc/<pid>/sched--------------------------------------
+
+//Values of one /proc/<pid>/sched dump that the import uses (times in microseconds)
+struct proc_sched_sample {
+    int             linux_PID = -1;
+    std::string     command;
+    std::int64_t    exec_start = 0;
+    std::int64_t    runtime = 0;            // se.sum_exec_runtime
+    std::int64_t    sleep = -1;             // sum_sleep_runtime (schedstats), -1 if absent
+    std::int64_t    voluntary = 0;          // nr_voluntary_switches
+};
+
+//Milliseconds with a fractional part ("1234.567890") to microseconds
+std::int64_t proc_time(const std::string &value) {
+    return std::llround(std::stod(value) * 1000);
+}
+
+//Adds the interval between two dumps of a task to its bursts
+void add_proc_interval(imported_task &task, const proc_sched_sample &previous, const proc_sched_sample &sample) {
+    std::int64_t cpu = std::max<std::int64_t>(0, sample.runtime - previous.runtime);
+    std::int64_t blocks = std::max<std::int64_t>(0, sample.voluntary - previous.voluntary);
+    std::int64_t io = (sample.sleep >= 0 && previous.sleep >= 0) ? sample.sleep - previous.sleep
+                    : (sample.exec_start - previous.exec_start) - cpu;
+    io = std::max<std::int64_t>(0, io);
+
+    if(blocks == 0) {
+        task.burst += cpu;
+        return;
+    }
+    for(std::int64_t i = 0; i < blocks; i++) {
+        task.bursts.push_back({task.burst + cpu / blocks, io / blocks});
+        task.burst = 0;
+    }
+}
+
+//Streams successive rounds of /proc/<pid>/sched dumps, emit receives the input line of every task once
+//a round misses it (or at the end), settled the simulated time before which every task has been emitted
+template<typename Emit, typename Settled>
+void import_proc_sched(std::istream &in, const import_options &options, Emit emit, Settled settled) {
+    std::map<int, imported_task> tasks;                 // Alive, by Linux PID
+    std::map<int, proc_sched_sample> last_samples;
+    int next_PID = 1;
+    std::set<int> in_round;                             // Linux PIDs dumped in the current round
+    bool first_round = true;
+    std::int64_t origin = INT64_MAX;                    // Earliest exec_start of the first round
+    std::int64_t round_latest = INT64_MIN;              // Latest exec_start of the current round
+    std::int64_t previous_round_latest = INT64_MIN;     // Latest exec_start of the previous round
+
+    // Emits the given tasks (by simulator PID) and forgets them
+    auto finish = [&](std::vector<int> linux_PIDs) {
+        std::sort(linux_PIDs.begin(), linux_PIDs.end(), [&](int first, int second) {
+            return tasks[first].PID < tasks[second].PID;
+        });
+        for(int linux_PID : linux_PIDs) {
+            imported_task &task = tasks[linux_PID];
+            // A task dumped once only shows its total CPU time
+            if(task.bursts.empty() && task.burst == 0) {
+                task.burst = last_samples[linux_PID].runtime;
+            }
+            emit(print_imported_task(task, origin, options));
+            tasks.erase(linux_PID);
+            last_samples.erase(linux_PID);
+        }
+    };
+
+    auto end_round = [&]() {
+        std::vector<int> exited;
+        for(const auto &entry : tasks) {
+            if(in_round.count(entry.first) == 0) {
+                exited.push_back(entry.first);
+            }
+        }
+        finish(exited);
+
+        // A task not dumped yet was started after the previous round was taken,
+        // its first exec_start is later than every exec_start of that round
+        if(!first_round && previous_round_latest != INT64_MIN) {
+            std::int64_t earliest = previous_round_latest;
+            for(const auto &entry : tasks) {
+                earliest = std::min(earliest, entry.second.first_seen);
+            }
+            settled(settled_ticks(earliest - origin, options));
+        }
+        first_round = false;
+        previous_round_latest = round_latest;
+        round_latest = INT64_MIN;
+        in_round.clear();
+    };
+
+    proc_sched_sample sample;
+    auto close_sample = [&]() {
+        if(sample.linux_PID == -1) {
+            return;
+        }
+        if(in_round.count(sample.linux_PID) > 0) {
+            end_round();
+        }
+        in_round.insert(sample.linux_PID);
+        round_latest = std::max(round_latest, sample.exec_start);
+
+        auto previous = last_samples.find(sample.linux_PID);
+        if(previous == last_samples.end()) {
+            imported_task &task = tasks[sample.linux_PID];
+            task.PID = next_PID++;
+            task.linux_PID = sample.linux_PID;
+            task.command = sample.command;
+            task.first_seen = sample.exec_start;
+            if(first_round) {
+                origin = std::min(origin, sample.exec_start);
+            }
+            if(options.map != nullptr) {
+                *options.map << task.PID << "\t" << task.linux_PID << "\t" << task.command << std::endl;
+            }
+            last_samples[sample.linux_PID] = sample;
+        } else {
+            add_proc_interval(tasks[sample.linux_PID], previous->second, sample);
+            previous->second = sample;
+        }
+        sample = proc_sched_sample();
+    };
+
+    std::string line;
+    while(std::getline(in, line)) {
+        // Header of a dump: "command (pid, #threads: n)"
+        std::size_t threads = line.find(", #threads:");
+        if(threads != std::string::npos) {
+            close_sample();
+            std::size_t open = line.find_last_of('(', threads);
+            if(open != std::string::npos) {
+                sample.linux_PID = std::atoi(line.substr(open + 1).c_str());
+                sample.command = line.substr(0, open > 0 ? open - 1 : 0);
+            }
+            continue;
+        }
+
+        std::size_t colon = line.find(':');
+        if(colon == std::string::npos || sample.linux_PID == -1) {
+            continue;
+        }
+        std::string key = line.substr(0, line.find_last_not_of(' ', colon - 1) + 1);
+        std::string value = line.substr(line.find_first_not_of(' ', colon + 1) == std::string::npos ? line.size()
+                                        : line.find_first_not_of(' ', colon + 1));
+        try {
+            if(key == "se.exec_start") {
+                sample.exec_start = proc_time(value);
+            } else if(key == "se.sum_exec_runtime") {
+                sample.runtime = proc_time(value);
+            } else if(key == "nr_voluntary_switches") {
+                sample.voluntary = std::stoll(value);
+            } else if(key == "se.statistics.sum_sleep_runtime" || key == "sum_sleep_runtime") {
+                sample.sleep = proc_time(value);
+            }
+        } catch(const std::exception &) {
+            continue;
+        }
+    }
+    close_sample();
+
+    // The tasks alive in the last round end with the trace
+    std::vector<int> alive;
+    for(const auto &entry : tasks) {
+        alive.push_back(entry.first);
+    }
+    finish(alive);
+}
+
+//Import settings given on the simulator command line
+import_options import_settings(const sim_config &config) {
+    import_options options;
+    options.tick_us = config.import_tick_us;
+    options.size = config.import_size;
+    return options;
+}
+
+//Imports a scheduler trace in the given format ("perf" or "proc"), returns false for an unknown format
+template<typename Emit, typename Settled>
+bool import_sched_trace(std::istream &in, const std::string &format, const import_options &options, Emit emit, Settled settled) {
+    if(format == "perf") {
+        import_perf_sched(in, options, emit, settled);
+    } else if(format == "proc") {
+        import_proc_sched(in, options, emit, settled);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template<typename Emit>
+bool import_sched_trace(std::istream &in, const std::string &format, const import_options &options, Emit emit) {
+    return import_sched_trace(in, format, options, emit, [](unsigned int) {});
+}
+
+//------------------------------------STREAMED SIMULATION------------------------------------
+
+//An import feeds a single run while the trace is read, returns false (with an error) for the modes that
+//need the whole workload up front
+bool import_compatible(const sim_config &config) {
+    std::string mode;
+    if(config.tune) {
+        mode = "--tune";
+    } else if(!config.fork_spec.empty()) {
+        mode = "--fork";
+    } else if(config.replicas > 0) {
+        mode = "--replicas";
+    } else if(config.daemon) {
+        mode = "--daemon";
+    } else if(!config.checkpoint_file.empty() || !config.resume_file.empty()) {
+        mode = "checkpoints";
+    }
+    if(!mode.empty()) {
+        std::cerr << "Error: --import cannot be combined with " << mode << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//Drops the terminated processes from the job list, nothing reads them again in a streamed run
+void forget_terminated(sim_state &state) {
+    auto terminated = std::remove_if(state.job_list.begin(), state.job_list.end(), [](const PCB &process) {
+        return process.state == TERMINATED;
+    });
+    state.job_list.erase(terminated, state.job_list.end());
+}
+
+//Runs the simulation of an imported trace while the trace is read. Every task the importer emits joins the
+//arrival list, as in the service mode, and the simulation advances up to the time the import has settled.
+//Only the tasks in progress, the arrivals to come and the live processes are held, whatever the trace length.
+//Returns tuple of execution status string, metrics and memory status
+template<typename Tick>
+std::tuple<std::string, sim_metrics, std::string> run_import_simulation(Tick tick, sim_state &state, const sim_config &config,
+                                                                        std::istream &in) {
+    track_memory(&state.recorder, &state.current_time);
+    bool admitted = false;      // A process has been admitted, the job list only holds the live ones
+    bool finished = false;      // Same end as run_simulation: every admitted process has terminated, or timeout
+    unsigned int late = 0;
+
+    auto advance = [&](unsigned int end_time) {
+        while(state.current_time < end_time && !finished) {
+            tick(state, config);
+            finish_tick(state);
+            admitted = admitted || !state.job_list.empty();
+            finished = admitted && std::all_of(state.job_list.begin(), state.job_list.end(), [](const PCB &process) {
+                return process.state == TERMINATED;
+            });
+            if(state.current_time > 100000) {
+                std::cerr << "Simulation timeout at 100000ms" << std::endl;
+                finished = true;
+            }
+        }
+        forget_arrivals(state);
+        forget_terminated(state);
+    };
+
+    import_sched_trace(in, config.import_format, import_settings(config), [&](const std::string &line) {
+        if(finished) {
+            return;
+        }
+        PCB process = add_process(split_delim(line, ", "));
+        // Only a trace out of time order delivers a task after the simulation passed its arrival
+        if(process.arrival_time < state.current_time) {
+            process.arrival_time = state.current_time;
+            late++;
+        }
+        state.list_processes.push_back(process);
+    }, [&](unsigned int settled) {
+        if(settled > state.current_time) {
+            advance(settled);
+        }
+    });
+
+    // The whole trace is in, run until every admitted process has terminated
+    while(!finished) {
+        advance(state.current_time + 1);
+    }
+    if(late > 0) {
+        std::cerr << "Note: " << late << " imported tasks came after their arrival time (trace out of order) and arrived late" << std::endl;
+    }
+
+    close_execution_table(state.recorder);
+    close_memory_status(state.recorder);
+    track_memory(nullptr, nullptr);
+
+    return std::make_tuple(state.recorder.execution_status, state.recorder.metrics, state.recorder.memory_status);
+}
+
+//Imports a trace file again from its start into a new run (e.g. the comparison without swapping)
+template<typename Tick>
+std::tuple<std::string, sim_metrics, std::string> run_import_simulation(Tick tick, const std::string &file_name, const sim_config &config) {
+    std::ifstream input_file(file_name);
+    sim_state state;
+    init_simulation(state, {}, config);
+    return run_import_simulation(tick, state, config, input_file);
+}
+
+#endif
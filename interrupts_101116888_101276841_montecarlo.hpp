@@ -0,0 +1,223 @@
+/**
+ * @file interrupts_101116888_101276841_montecarlo.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Monte Carlo mode: seeded replicas of a workload with random timings
+ *
+ * The CPU time, I/O frequency and I/O duration of an input line may be
+ * distributions instead of fixed values:
+ *   300           fixed value
+ *   300~50        normal distribution, mean 300 and standard deviation 50
+ *   10:2|20:5|40:3  empirical histogram, value:weight pairs
+ * Every replica draws the values of every process from its own seed (the
+ * base seed and the replica number), so a replica is reproducible and the
+ * same seed gives all schedulers the same sampled workloads. The replicas
+ * run in parallel and the metrics are reported with 95% confidence intervals.
+ */
+
+#ifndef INTERRUPTS_MONTECARLO_HPP_
+#define INTERRUPTS_MONTECARLO_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+
+#include<atomic>
+
+//A timing field of the input file
+struct value_distribution {
+    double                  mean = 0;
+    double                  deviation = 0;      // Normal distribution when > 0
+    std::vector<double>     values;             // Empirical histogram when not empty
+    std::vector<double>     weights;
+
+    bool fixed() const {
+        return deviation == 0 && values.empty();
+    }
+
+    //Draws a value, never below lowest unless the field is a fixed value
+    unsigned int sample(std::mt19937_64 &random, unsigned int lowest) const {
+        double value = mean;
+        if(!values.empty()) {
+            std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+            value = values[pick(random)];
+        } else if(deviation > 0) {
+            value = std::normal_distribution<double>(mean, deviation)(random);
+        } else {
+            return (unsigned int) std::lround(mean);
+        }
+        return (unsigned int) std::max((double) lowest, std::round(value));
+    }
+};
+
+//Line of the input file with distributions for its timing fields
+struct process_distribution {
+    PCB                     process;            // Fixed fields (PID, size, arrival)
+    value_distribution      processing_time;
+    value_distribution      io_freq;
+    value_distribution      io_duration;
+};
+
+//Parses "300", "300~50" or "10:2|20:5|40:3", returns false if the text is none of them
+bool parse_distribution(const std::string &text, value_distribution &distribution) {
+    try {
+        if(text.find(':') != std::string::npos) {
+            for(const auto &bucket : split_delim(text, "|")) {
+                auto pair = split_delim(bucket, ":");
+                if(pair.size() != 2) {
+                    return false;
+                }
+                distribution.values.push_back(std::stod(pair[0]));
+                distribution.weights.push_back(std::stod(pair[1]));
+            }
+            return true;
+        }
+        auto parts = split_delim(text, "~");
+        if(parts.size() > 2) {
+            return false;
+        }
+        distribution.mean = std::stod(parts[0]);
+        distribution.deviation = (parts.size() == 2) ? std::stod(parts[1]) : 0;
+        return distribution.mean >= 0 && distribution.deviation >= 0;
+    } catch(const std::exception &) {
+        return false;
+    }
+}
+
+bool read_distributions(const std::string &file_name, std::vector<process_distribution> &workload) {
+    std::ifstream input_file(file_name);
+    std::string line;
+    while(std::getline(input_file, line)) {
+        if(line.empty()) {
+            continue;
+        }
+        auto input_tokens = split_delim(line, ", ");
+        process_distribution entry;
+        bool valid = input_tokens.size() == 6;
+        if(valid) {
+            entry.process = add_process(input_tokens);
+            valid = parse_distribution(input_tokens[3], entry.processing_time)
+                 && parse_distribution(input_tokens[4], entry.io_freq)
+                 && parse_distribution(input_tokens[5], entry.io_duration);
+        }
+        if(!valid) {
+            std::cerr << "Error: invalid process line: " << line << std::endl;
+            return false;
+        }
+        workload.push_back(entry);
+    }
+    return !workload.empty();
+}
+
+//Concrete workload of one replica
+std::vector<PCB> sample_workload(const std::vector<process_distribution> &workload, unsigned int seed, unsigned int replica) {
+    std::seed_seq sequence = {seed, replica};
+    std::mt19937_64 random(sequence);
+
+    std::vector<PCB> processes;
+    for(const auto &entry : workload) {
+        PCB process = entry.process;
+        process.processing_time = entry.processing_time.sample(random, 1);
+        process.remaining_time = process.processing_time;
+        process.io_freq = entry.io_freq.sample(random, 1);
+        process.io_duration = entry.io_duration.sample(random, 1);
+        processes.push_back(process);
+    }
+    return processes;
+}
+
+//------------------------------------REPLICAS-----------------------------------------------
+
+//Metrics of every replica
+struct monte_carlo_result {
+    unsigned int                    seed;
+    std::vector<metrics_summary>    replicas;
+};
+
+//Runs the replicas on all cores, each worker takes the next replica until all are done
+template<typename Simulator>
+monte_carlo_result run_replicas(Simulator simulate, const std::vector<process_distribution> &workload, sim_config config) {
+    monte_carlo_result result;
+    result.seed = config.seed;
+    result.replicas.resize(config.replicas);
+    config.checkpoint_file.clear();
+    config.memory_status = false;
+
+    std::atomic<unsigned int> next_replica{0};
+    unsigned int workers = std::min(config.replicas, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(unsigned int i = 0; i < workers; i++) {
+        threads.emplace_back([&]() {
+            for(unsigned int replica = next_replica++; replica < config.replicas; replica = next_replica++) {
+                auto [exec, metrics, memory] = simulate(sample_workload(workload, config.seed, replica), config);
+                result.replicas[replica] = summarize(metrics);
+            }
+        });
+    }
+    for(auto &thread : threads) {
+        thread.join();
+    }
+
+    return result;
+}
+
+//Two-sided 95% critical value of Student's t distribution
+double t_critical(std::size_t degrees_of_freedom) {
+    const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if(degrees_of_freedom == 0) {
+        return 0;
+    }
+    return (degrees_of_freedom <= std::size(table)) ? table[degrees_of_freedom - 1] : 1.96;
+}
+
+//Mean and half width of the 95% confidence interval of the mean
+std::pair<double, double> confidence_interval(const std::vector<double> &values) {
+    double average = mean(values);
+    if(values.size() < 2) {
+        return {average, 0};
+    }
+    double squares = 0;
+    for(double value : values) {
+        squares += (value - average) * (value - average);
+    }
+    double deviation = std::sqrt(squares / (values.size() - 1));
+    return {average, t_critical(values.size() - 1) * deviation / std::sqrt((double) values.size())};
+}
+
+std::string print_monte_carlo(const monte_carlo_result &result, const std::string &policy) {
+    const std::vector<std::pair<std::string, double metrics_summary::*>> rows = {
+        {"Mean turnaround (ms)", &metrics_summary::mean_turnaround},
+        {"Mean response (ms)", &metrics_summary::mean_response},
+        {"p99 response (ms)", &metrics_summary::p99_response},
+        {"Mean wait (ms)", &metrics_summary::mean_wait},
+        {"Throughput (proc/s)", &metrics_summary::throughput},
+    };
+    std::stringstream buffer;
+
+    buffer << "Monte Carlo " << policy << ": " << result.replicas.size() << " replicas, seed " << result.seed << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(70) << "+" << std::endl;
+    buffer << "|" << std::setfill(' ') << std::setw(21) << "Metric"
+           << std::setw(2) << "|" << std::setw(10) << "Mean"
+           << std::setw(2) << "|" << std::setw(10) << "+/- 95%"
+           << std::setw(2) << "|" << std::setw(21) << "95% CI"
+           << std::setw(2) << "|" << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(70) << "+" << std::endl;
+    for(const auto &row : rows) {
+        std::vector<double> values;
+        for(const auto &replica : result.replicas) {
+            values.push_back(replica.*(row.second));
+        }
+        auto [average, half_width] = confidence_interval(values);
+        std::stringstream interval;
+        interval << std::fixed << std::setprecision(2) << average - half_width << " - " << average + half_width;
+        buffer << "|" << std::setfill(' ') << std::setw(21) << row.first
+               << std::setw(2) << "|" << std::setw(10) << std::fixed << std::setprecision(2) << average
+               << std::setw(2) << "|" << std::setw(10) << half_width
+               << std::setw(2) << "|" << std::setw(21) << interval.str()
+               << std::setw(2) << "|" << std::endl;
+    }
+    buffer << "+" << std::setfill('-') << std::setw(70) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+#endif
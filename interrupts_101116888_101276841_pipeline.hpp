@@ -0,0 +1,134 @@
+/**
+ * @file interrupts_101116888_101276841_pipeline.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Pipelined mode: simulation and table writing on separate threads
+ *
+ * The stages are connected by a bounded single-producer single-consumer ring
+ * buffer. A producer facing a full ring waits for the consumer (back-pressure),
+ * so the memory in flight stays bounded whatever the length of the run.
+ *   simulation (calling thread) --transition records--> writer thread (formats and writes the table)
+ * The input file is parsed before the simulation starts: arrivals may be listed
+ * in any order, so a parser stage could not overlap with the simulation.
+ */
+
+#ifndef INTERRUPTS_PIPELINE_HPP_
+#define INTERRUPTS_PIPELINE_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_trace.hpp"
+
+#include<atomic>
+
+const std::size_t PIPELINE_RING_SIZE = 4096;            // Records per ring (power of 2)
+const std::size_t PIPELINE_WRITE_SIZE = 1 << 16;        // Formatted bytes collected before a write
+
+//Bounded lock-free ring buffer between one producer and one consumer thread
+template<typename T>
+struct spsc_ring {
+    std::vector<T>                      slots;
+    std::size_t                         mask;
+    alignas(64) std::atomic<std::size_t> head{0};       // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<std::size_t> tail{0};       // Next slot to push, written by the producer
+    std::atomic<bool>                   closed{false};  // Producer is done
+
+    explicit spsc_ring(std::size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+    bool try_push(const T &value) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        if(position - head.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[position & mask] = value;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &value) {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        if(position == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Waits while the ring is full
+    void push(const T &value) {
+        while(!try_push(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    //Waits for the next value, returns false once the producer closed the ring and it is empty
+    bool pop(T &value) {
+        while(!try_pop(value)) {
+            if(closed.load(std::memory_order_acquire)) {
+                return try_pop(value);
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+    }
+};
+
+//------------------------------------FORMAT/WRITE STAGE-------------------------------------
+
+//Hands every transition to a writer thread that formats the execution table and writes it out
+struct pipeline_writer : transition_sink {
+    spsc_ring<trace_record>     ring{PIPELINE_RING_SIZE};
+    std::ofstream               file;
+    std::thread                 writer;
+    bool                        finished = false;
+
+    void record(unsigned int current_time, int PID, states old_state, states new_state) override {
+        ring.push({current_time, PID, old_state, new_state});
+    }
+
+    void write_table() {
+        std::string buffer = print_exec_header();
+        trace_record record;
+        while(ring.pop(record)) {
+            buffer += print_exec_status(record.time, record.PID, record.old_state, record.new_state);
+            if(buffer.size() >= PIPELINE_WRITE_SIZE) {
+                file << buffer;
+                buffer.clear();
+            }
+        }
+        file << buffer << print_exec_footer();
+    }
+
+    //Waits for the writer to drain the ring and closes the table
+    void finish() {
+        if(finished) {
+            return;
+        }
+        ring.close();
+        if(writer.joinable()) {
+            writer.join();
+        }
+        file.close();
+        finished = true;
+    }
+
+    ~pipeline_writer() {
+        finish();
+    }
+};
+
+std::shared_ptr<pipeline_writer> start_pipeline_writer(const std::string &file_name) {
+    auto stage = std::make_shared<pipeline_writer>();
+    stage->file.open(file_name, std::ios::binary | std::ios::trunc);
+    if(!stage->file.is_open()) {
+        std::cerr << "Error: Unable to open output file: " << file_name << std::endl;
+        return nullptr;
+    }
+    stage->writer = std::thread(&pipeline_writer::write_table, stage.get());
+    return stage;
+}
+
+#endif
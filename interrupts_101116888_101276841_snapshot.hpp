@@ -0,0 +1,493 @@
+/**
+ * @file interrupts_101116888_101276841_snapshot.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief State snapshots and time index alongside a binary trace
+ *
+ * The process table at any time can be rebuilt by replaying the transitions of
+ * the trace. To avoid replaying from the start, <trace>.idx holds snapshots of
+ * the table taken every few thousand records, and a sparse index of their
+ * times. A query binary-searches the index, loads the nearest snapshot and
+ * replays only the records after it.
+ *
+ * The replay only knows what the transitions say: a process runs every ms
+ * after its dispatch while RUNNING and holds no partition once TERMINATED.
+ * At the end of every ms the index writer compares the replayed rows with the
+ * PCBs and the partition table of the engine. Where they differ (a process
+ * seen for the first time, overhead before the CPU runs a process, a swap, an
+ * EP_RR preemption on arrival, ...) it writes the engine's row as a correction
+ * the replay applies at the end of that ms, so the table is exact at every ms.
+ *
+ * File layout, blocks are written as the run goes, in time order:
+ *   header    : magic "SIDX", version
+ *   correction: time, row of a live process as the engine holds it at the end of that ms
+ *   terminated: time, offset of the previous terminated block, final row of the process
+ *   snapshot  : time, trace offset, last terminated block, terminated count, processes seen, live rows
+ *   footer    : (time, offset) of every snapshot, footer offset, magic
+ * A snapshot only holds the processes still alive, the terminated ones never
+ * change and are read back through the chain of terminated blocks. The footer
+ * is written when the run ends, without it a query finds the snapshots by
+ * reading the blocks in order.
+ */
+
+#ifndef INTERRUPTS_SNAPSHOT_HPP_
+#define INTERRUPTS_SNAPSHOT_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_trace.hpp"
+#include "interrupts_101116888_101276841_checkpoint.hpp"
+#include "interrupts_101116888_101276841_soa.hpp"
+
+const std::uint32_t INDEX_MAGIC = 0x58444953;     // "SIDX"
+const std::uint32_t INDEX_VERSION = 2;
+
+enum index_blocks : std::uint8_t {
+    CORRECTION_BLOCK = 'C',
+    TERMINATED_BLOCK = 'T',
+    SNAPSHOT_BLOCK = 'S'
+};
+
+//A process of the table, as replayed or as read from the engine
+struct replay_process {
+    int             PID;
+    std::uint32_t   order;              // Rank of its first transition (table order)
+    unsigned int    size;
+    unsigned int    arrival_time;
+    unsigned int    processing_time;
+    int             start_time;
+    unsigned int    remaining_time;     // As of run_from while RUNNING
+    int             partition_number;
+    std::uint32_t   state;
+    unsigned int    run_from;           // While RUNNING, last ms before the CPU runs it again
+};
+
+//Where a snapshot is in the index file
+struct index_entry {
+    unsigned int    time;
+    std::uint64_t   offset;
+};
+
+//------------------------------------REPLAY-------------------------------------------------
+
+//Remaining time of a process at the end of the given ms
+unsigned int remaining_at(const replay_process &process, unsigned int time) {
+    if(process.state != RUNNING || time <= process.run_from) {
+        return process.remaining_time;
+    }
+    return process.remaining_time - std::min(time - process.run_from, process.remaining_time);
+}
+
+struct trace_replay {
+    std::vector<replay_process>     live;           // Processes seen and not terminated
+    std::vector<replay_process>     terminated;     // In termination order
+    std::uint32_t                   seen = 0;       // Processes seen so far
+    std::vector<int>                discovered;     // Seen for the first time, their rows are not known yet
+
+    //Live processes are few (they hold a partition or are swapped out), a linear search is enough
+    replay_process &find(int PID) {
+        for(auto &process : live) {
+            if(process.PID == PID) {
+                return process;
+            }
+        }
+        discovered.push_back(PID);
+        live.push_back({PID, seen++, 0, 0, 0, -1, 0, -1, NEW, 0});
+        return live.back();
+    }
+
+    void apply(const trace_record &record) {
+        // EP reports the idle CPU as PID -1, it is not a process
+        if(record.PID < 0) {
+            return;
+        }
+        replay_process &process = find(record.PID);
+
+        if(record.old_state == RUNNING) {
+            process.remaining_time = remaining_at(process, record.time);
+        }
+        if(record.new_state == RUNNING) {
+            process.run_from = record.time;
+            if(process.start_time == -1) {
+                process.start_time = record.time;
+            }
+        }
+        process.state = record.new_state;
+
+        if(record.new_state == TERMINATED) {
+            process.remaining_time = 0;
+            process.partition_number = -1;
+            terminated.push_back(process);
+            live.erase(live.begin() + (&process - live.data()));
+        }
+    }
+
+    //Replaces the row of a process with the one the engine had at the end of the ms
+    void correct(const replay_process &row) {
+        for(auto &process : live) {
+            if(process.PID == row.PID) {
+                process = row;
+                return;
+            }
+        }
+        live.push_back(row);
+    }
+
+    PCB row(const replay_process &process, unsigned int time) const {
+        PCB row = PCB();
+        row.PID = process.PID;
+        row.size = process.size;
+        row.arrival_time = process.arrival_time;
+        row.processing_time = process.processing_time;
+        row.start_time = process.start_time;
+        row.partition_number = process.partition_number;
+        row.state = (states) process.state;
+        row.remaining_time = remaining_at(process, time);
+        row.priority = row.size;
+        return row;
+    }
+
+    //Process table at the given time (all records up to that time applied), in order of first transition
+    std::vector<PCB> table(unsigned int time) const {
+        std::vector<replay_process> processes = terminated;
+        processes.insert(processes.end(), live.begin(), live.end());
+        std::sort(processes.begin(), processes.end(), [](const replay_process &first, const replay_process &second) {
+            return first.order < second.order;
+        });
+
+        std::vector<PCB> rows;
+        for(const auto &process : processes) {
+            rows.push_back(row(process, time));
+        }
+        return rows;
+    }
+};
+
+//------------------------------------ENGINE STATE-------------------------------------------
+
+//Partition holding process PID in the partition table, -1 if none
+int partition_of(int PID) {
+    for(const auto &partition : memory_paritions) {
+        if(partition.occupied == PID) {
+            return partition.partition_number;
+        }
+    }
+    return -1;
+}
+
+//Fills row with process PID as the reference engine holds it, false if the engine does not hold it
+//slot is where the process was found last time (the job list only grows)
+bool engine_row(const sim_state &state, int PID, std::size_t &slot, replay_process &row) {
+    const PCB *process = nullptr;
+    if(state.running.state == RUNNING && state.running.PID == PID) {
+        process = &state.running;
+    } else {
+        const auto &job_list = state.job_list;
+        if(slot >= job_list.size() || job_list[slot].PID != PID) {
+            auto found = std::find_if(job_list.begin(), job_list.end(), [&](const PCB &job) {
+                return job.PID == PID;
+            });
+            if(found == job_list.end()) {
+                return false;
+            }
+            slot = found - job_list.begin();
+        }
+        process = &job_list[slot];
+    }
+    row.size = process->size;
+    row.arrival_time = process->arrival_time;
+    row.processing_time = process->processing_time;
+    row.start_time = process->start_time;
+    row.remaining_time = process->remaining_time;
+    row.partition_number = partition_of(PID);
+    return true;
+}
+
+//Same for the table engine, slot is the row of the process in the table
+bool engine_row(const table_state &state, int PID, std::size_t &slot, replay_process &row) {
+    const process_table &table = state.table;
+    if(slot >= table.PID.size() || table.PID[slot] != PID) {
+        auto found = std::find(table.PID.begin(), table.PID.end(), PID);
+        if(found == table.PID.end()) {
+            return false;
+        }
+        slot = found - table.PID.begin();
+    }
+    row.size = table.size[slot];
+    row.arrival_time = table.arrival_time[slot];
+    row.processing_time = table.processing_time[slot];
+    row.start_time = table.start_time[slot];
+    row.remaining_time = table.remaining_time[slot];
+    row.partition_number = partition_of(PID);
+    return true;
+}
+
+//Returns true if the replayed row matches the engine's at the end of the ms, and keeps matching until the next event
+bool same_row(const replay_process &replayed, const replay_process &engine, unsigned int time) {
+    return replayed.size == engine.size
+        && replayed.arrival_time == engine.arrival_time
+        && replayed.processing_time == engine.processing_time
+        && replayed.start_time == engine.start_time
+        && replayed.partition_number == engine.partition_number
+        && remaining_at(replayed, time) == engine.remaining_time
+        && (engine.state != RUNNING || std::max(replayed.run_from, time) == engine.run_from);
+}
+
+//------------------------------------INDEX WRITER-------------------------------------------
+
+//Follows the binary trace writer (registered right after it) and the engine state at the end of every ms
+struct trace_index_writer : transition_sink {
+    std::ofstream                           file;
+    std::shared_ptr<binary_trace_writer>    trace;
+    trace_replay                            replay;
+    std::map<int, std::size_t>              slots;          // Where each live process is in the engine
+    std::vector<index_entry>                entries;
+    std::uint64_t                           last_terminated = 0;    // Offset of the last terminated block, 0 = none
+    std::uint64_t                           terminated = 0;         // Terminated blocks written
+    std::uint32_t                           every = 1;      // Records between two snapshots
+    std::uint64_t                           records = 0;    // Since the last snapshot
+
+    void begin_block(index_blocks kind, unsigned int time) {
+        write_pod(file, kind);
+        write_pod(file, time);
+    }
+
+    void snapshot(unsigned int time) {
+        entries.push_back({time, (std::uint64_t) file.tellp()});
+        begin_block(SNAPSHOT_BLOCK, time);
+        write_pod(file, (std::uint64_t) (trace->position + trace->buffer.size()));
+        write_pod(file, last_terminated);
+        write_pod(file, terminated);
+        write_pod(file, replay.seen);
+        write_pods(file, replay.live);
+        records = 0;
+    }
+
+    void record(unsigned int current_time, int PID, states old_state, states new_state) override {
+        replay.apply({current_time, PID, old_state, new_state});
+        records++;
+    }
+
+    template<typename State>
+    void end_of_tick(const State &state) {
+        unsigned int time = state.current_time - 1;     // The ms that just ended
+
+        for(auto &process : replay.live) {
+            replay_process engine = process;
+            if(!engine_row(state, process.PID, slots[process.PID], engine)) {
+                continue;
+            }
+            // The CPU works off the pending overhead before running the process again
+            engine.run_from = (engine.state == RUNNING) ? time + state.overhead_pending : process.run_from;
+            bool discovered = std::find(replay.discovered.begin(), replay.discovered.end(), process.PID) != replay.discovered.end();
+            if(discovered || !same_row(process, engine, time)) {
+                process = engine;
+                begin_block(CORRECTION_BLOCK, time);
+                write_pod(file, engine);
+            }
+        }
+        replay.discovered.clear();
+
+        // Final rows are written as the processes terminate
+        for(const auto &process : replay.terminated) {
+            replay_process engine = process;
+            engine_row(state, process.PID, slots[process.PID], engine);
+            slots.erase(process.PID);
+
+            std::uint64_t offset = file.tellp();
+            begin_block(TERMINATED_BLOCK, time);
+            write_pod(file, last_terminated);
+            write_pod(file, engine);
+            last_terminated = offset;
+            terminated++;
+        }
+        replay.terminated.clear();
+
+        if(records >= every) {
+            snapshot(time);
+        }
+    }
+
+    void tick_done(const sim_state &state) override {
+        end_of_tick(state);
+    }
+
+    void tick_done(const table_state &state) override {
+        end_of_tick(state);
+    }
+
+    ~trace_index_writer() {
+        std::uint64_t footer = file.tellp();
+        write_pods(file, entries);
+        write_pod(file, footer);
+        write_pod(file, INDEX_MAGIC);
+    }
+};
+
+std::shared_ptr<trace_index_writer> open_trace_index(const std::string &file_name, std::shared_ptr<binary_trace_writer> trace,
+                                                     std::uint32_t every) {
+    auto writer = std::make_shared<trace_index_writer>();
+    writer->file.open(file_name, std::ios::binary | std::ios::trunc);
+    if(!writer->file.is_open()) {
+        std::cerr << "Error: Unable to open index file: " << file_name << std::endl;
+        return nullptr;
+    }
+    writer->trace = trace;
+    writer->every = std::max(1u, every);
+
+    write_pod(writer->file, INDEX_MAGIC);
+    write_pod(writer->file, INDEX_VERSION);
+
+    // Snapshot of the empty table so every query finds one at or before its time
+    writer->snapshot(0);
+    return writer;
+}
+
+//------------------------------------QUERIES------------------------------------------------
+
+const std::streamoff INDEX_HEADER_SIZE = 2 * sizeof(std::uint32_t);
+
+bool read_block_head(std::istream &in, std::uint8_t &kind, unsigned int &time) {
+    return read_pod(in, kind) && read_pod(in, time);
+}
+
+//Moves past the body of a block whose head was just read, false if the block is cut short
+bool skip_block(std::istream &in, std::uint8_t kind) {
+    std::streamoff length = 0;
+    if(kind == CORRECTION_BLOCK) {
+        length = sizeof(replay_process);
+    } else if(kind == TERMINATED_BLOCK) {
+        length = sizeof(std::uint64_t) + sizeof(replay_process);
+    } else if(kind == SNAPSHOT_BLOCK) {
+        in.seekg(3 * sizeof(std::uint64_t) + sizeof(std::uint32_t), std::ios::cur);
+        std::uint32_t count = 0;
+        if(!read_count(in, count, sizeof(replay_process))) {
+            return false;
+        }
+        length = (std::streamoff) count * sizeof(replay_process);
+    } else {
+        return false;
+    }
+    std::streampos body = in.tellg();
+    in.seekg(0, std::ios::end);
+    if(in.tellg() - body < length) {
+        return false;
+    }
+    in.seekg(body + length);
+    return (bool) in;
+}
+
+//Loads the time index of a trace index file, from its footer or, if the run did not write one, from its blocks
+bool load_trace_index(std::ifstream &in, const std::string &file_name, std::vector<index_entry> &entries) {
+    in.open(file_name, std::ios::binary);
+    std::uint32_t magic = 0, version = 0;
+    if(!read_pod(in, magic) || magic != INDEX_MAGIC || !read_pod(in, version) || version != INDEX_VERSION) {
+        return false;
+    }
+
+    std::uint64_t footer = 0;
+    in.seekg(-(std::streamoff) (sizeof(footer) + sizeof(magic)), std::ios::end);
+    if(read_pod(in, footer) && read_pod(in, magic) && magic == INDEX_MAGIC && footer >= (std::uint64_t) INDEX_HEADER_SIZE) {
+        in.seekg(footer);
+        if(read_pods(in, entries) && !entries.empty()) {
+            return true;
+        }
+    }
+
+    entries.clear();
+    in.clear();
+    in.seekg(INDEX_HEADER_SIZE);
+    std::uint8_t kind;
+    unsigned int time;
+    std::uint64_t offset = in.tellg();
+    while(read_block_head(in, kind, time) && skip_block(in, kind)) {
+        if(kind == SNAPSHOT_BLOCK) {
+            entries.push_back({time, offset});
+        }
+        offset = in.tellg();
+    }
+    in.clear();
+    return !entries.empty();
+}
+
+//Rebuilds the process table at the given time from the nearest snapshot at or before it
+//Returns false if the trace or its index cannot be read
+bool query_trace(const std::string &trace_file, unsigned int time, std::vector<PCB> &table, std::size_t &replayed) {
+    std::ifstream index;
+    std::vector<index_entry> entries;
+    if(!load_trace_index(index, trace_file + ".idx", entries)) {
+        std::cerr << "Error: " << trace_file << ".idx is not a trace index" << std::endl;
+        return false;
+    }
+
+    // Last snapshot taken at or before the requested time
+    auto after = std::upper_bound(entries.begin(), entries.end(), time, [](unsigned int value, const index_entry &entry) {
+        return value < entry.time;
+    });
+    const index_entry &nearest = *(after == entries.begin() ? after : after - 1);
+
+    trace_replay replay;
+    std::uint8_t kind = 0;
+    unsigned int snapshot_time = 0;
+    std::uint64_t trace_offset = 0, last_terminated = 0, terminated = 0;
+    index.seekg(nearest.offset);
+    bool valid = read_block_head(index, kind, snapshot_time) && kind == SNAPSHOT_BLOCK
+              && read_pod(index, trace_offset) && read_pod(index, last_terminated) && read_pod(index, terminated)
+              && read_pod(index, replay.seen) && read_pods(index, replay.live);
+
+    // Corrections made after the snapshot, up to the requested time
+    std::vector<std::pair<unsigned int, replay_process>> corrections;
+    unsigned int block_time = 0;
+    std::streampos next_block = index.tellg();
+    while(valid && read_block_head(index, kind, block_time) && block_time <= time && kind != SNAPSHOT_BLOCK) {
+        replay_process row;
+        if(kind == CORRECTION_BLOCK && read_pod(index, row)) {
+            corrections.push_back({block_time, row});
+        } else if(kind != TERMINATED_BLOCK || !skip_block(index, kind)) {
+            break;
+        }
+    }
+    index.clear();
+    index.seekg(next_block);
+
+    // Processes terminated before the snapshot, following the chain back from the last one
+    for(std::uint64_t offset = last_terminated; valid && replay.terminated.size() < terminated; ) {
+        replay_process row;
+        index.seekg(offset);
+        valid = read_block_head(index, kind, block_time) && kind == TERMINATED_BLOCK
+             && read_pod(index, offset) && read_pod(index, row);
+        replay.terminated.push_back(row);
+    }
+    std::reverse(replay.terminated.begin(), replay.terminated.end());
+    if(!valid) {
+        std::cerr << "Error: damaged snapshot in " << trace_file << ".idx" << std::endl;
+        return false;
+    }
+
+    binary_trace_reader reader;
+    trace_header header;
+    if(!reader.open(trace_file, header)) {
+        std::cerr << "Error: " << trace_file << " is not a binary trace" << std::endl;
+        return false;
+    }
+    reader.file.seekg(trace_offset);
+    reader.previous_time = snapshot_time;
+
+    // A correction applies once every record of its ms is replayed
+    replayed = 0;
+    std::size_t next = 0;
+    trace_record record;
+    while(reader.next(record) && record.time <= time) {
+        for(; next < corrections.size() && corrections[next].first < record.time; next++) {
+            replay.correct(corrections[next].second);
+        }
+        replay.apply(record);
+        replayed++;
+    }
+    for(; next < corrections.size(); next++) {
+        replay.correct(corrections[next].second);
+    }
+
+    table = replay.table(time);
+    return true;
+}
+
+#endif
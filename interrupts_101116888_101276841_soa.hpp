@@ -0,0 +1,297 @@
+/**
+ * @file interrupts_101116888_101276841_soa.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Struct-of-arrays process table and the state of the table engine
+ *
+ * Every process is stored once, as one row of the table. The queues and the
+ * running slot hold 32-bit row handles, so a transition moves a handle instead
+ * of copying a PCB. The columns the scheduler reads every ms (remaining time,
+ * state, priority, time in CPU) are kept apart from the ones it rarely touches.
+ * The table engine (--engine soa) produces exactly the output of the reference one.
+ */
+
+#ifndef INTERRUPTS_SOA_HPP_
+#define INTERRUPTS_SOA_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+
+typedef std::uint32_t process_handle;
+
+const process_handle NO_PROCESS = 0xffffffff;     // Idle CPU
+
+struct process_table {
+    // Hot columns, used by the scheduler loop
+    std::vector<unsigned int>   remaining_time;
+    std::vector<enum states>    state;
+    std::vector<unsigned int>   priority;
+    std::vector<unsigned int>   time_in_cpu;
+
+    // Cold columns, used on transitions only
+    std::vector<int>            PID;
+    std::vector<unsigned int>   size;
+    std::vector<unsigned int>   arrival_time;
+    std::vector<int>            start_time;
+    std::vector<unsigned int>   processing_time;
+    std::vector<int>            partition_number;
+    std::vector<unsigned int>   io_freq;
+    std::vector<unsigned int>   io_duration;
+    std::vector<std::shared_ptr<const burst_schedule>> bursts;
+};
+
+//Adds a process to the table, returns the handle of its row
+process_handle add_row(process_table &table, const PCB &process) {
+    table.remaining_time.push_back(process.remaining_time);
+    table.state.push_back(process.state);
+    table.priority.push_back(process.priority);
+    table.time_in_cpu.push_back(process.time_in_cpu);
+
+    table.PID.push_back(process.PID);
+    table.size.push_back(process.size);
+    table.arrival_time.push_back(process.arrival_time);
+    table.start_time.push_back(process.start_time);
+    table.processing_time.push_back(process.processing_time);
+    table.partition_number.push_back(process.partition_number);
+    table.io_freq.push_back(process.io_freq);
+    table.io_duration.push_back(process.io_duration);
+    table.bursts.push_back(process.bursts);
+
+    return (process_handle) (table.PID.size() - 1);
+}
+
+//Rebuilds the PCB of a row
+PCB get_row(const process_table &table, process_handle handle) {
+    PCB process;
+    process.PID = table.PID[handle];
+    process.size = table.size[handle];
+    process.arrival_time = table.arrival_time[handle];
+    process.start_time = table.start_time[handle];
+    process.processing_time = table.processing_time[handle];
+    process.remaining_time = table.remaining_time[handle];
+    process.partition_number = table.partition_number[handle];
+    process.state = table.state[handle];
+    process.io_freq = table.io_freq[handle];
+    process.io_duration = table.io_duration[handle];
+    process.priority = table.priority[handle];
+    process.time_in_cpu = table.time_in_cpu[handle];
+    process.bursts = table.bursts[handle];
+    return process;
+}
+
+//Returns true if the process requests I/O once it has used cpu_time ms of CPU
+bool io_due(const process_table &table, process_handle process, unsigned int cpu_time) {
+    return io_due(table.bursts[process].get(), table.io_freq[process], cpu_time);
+}
+
+//Duration of the I/O the process requests (or is waiting for) at its current CPU time
+unsigned int io_length(const process_table &table, process_handle process) {
+    return io_length(table.bursts[process].get(), table.io_duration[process], table.processing_time[process] - table.remaining_time[process]);
+}
+
+//PCB table of the processes in a handle queue, same layout as print_PCB
+std::string print_PCB(const process_table &table, const std::vector<process_handle> &queue) {
+    std::vector<PCB> processes;
+    for(auto handle : queue) {
+        processes.push_back(get_row(table, handle));
+    }
+    return print_PCB(processes);
+}
+
+//--------------------------------------------TABLE ENGINE STATE-------------------------------------
+
+//State of a simulation run by the table engine, the counterpart of sim_state
+struct table_state {
+    process_table                   table;
+    std::vector<process_handle>     arrivals;           // All processes by arrival time (input order among equals)
+    std::size_t                     next_arrival = 0;   // First entry of arrivals that has not arrived yet
+    std::vector<process_handle>     ready_queue;
+    std::vector<process_handle>     wait_queue;
+    std::vector<process_handle>     job_list;           // Admitted processes, in admission order
+    process_handle                  running = NO_PROCESS;
+    std::size_t                     terminated = 0;     // Processes of job_list that have terminated
+    unsigned int                    current_time = 0;
+    unsigned int                    overhead_pending = 0;
+    unsigned int                    quantum_remaining = 0;
+    unsigned int                    io_start_time = 0;  // Start of the last I/O (EP scheduler)
+    sim_recorder                    recorder;
+    io_subsystem                    io;
+};
+
+//Returns the reason the table engine cannot run with these options, empty if it can
+std::string table_engine_unsupported(const sim_config &config) {
+    if(config.swapping) {
+        return "--swap";
+    }
+    if(!config.checkpoint_file.empty() || !config.resume_file.empty()) {
+        return "checkpoints";
+    }
+    if(!config.fork_spec.empty()) {
+        return "--fork";
+    }
+    if(config.memory_status) {
+        return "--memory-status";
+    }
+    if(config.daemon) {
+        return "the service mode";
+    }
+    if(!config.import_format.empty()) {
+        return "--import";
+    }
+    return "";
+}
+
+//Falls back to the reference engine for the options the table engine does not cover
+void choose_engine(sim_config &config) {
+    std::string unsupported = table_engine_unsupported(config);
+    if(config.engine == TABLE_ENGINE && !unsupported.empty()) {
+        std::cerr << "Note: --engine soa does not support " << unsupported << ", using the reference engine" << std::endl;
+        config.engine = REFERENCE_ENGINE;
+    }
+}
+
+//Sets up a table simulation that starts at time 0
+void init_table_simulation(table_state &state, const std::vector<PCB> &list_processes, const sim_config &config) {
+    state = table_state();
+    state.quantum_remaining = config.time_quantum;
+
+    for(const auto &process : list_processes) {
+        state.arrivals.push_back(add_row(state.table, process));
+    }
+    const auto &arrival_time = state.table.arrival_time;
+    std::stable_sort(state.arrivals.begin(), state.arrivals.end(), [&](process_handle first, process_handle second) {
+        return arrival_time[first] < arrival_time[second];
+    });
+
+    // Room for every process, so the queues never reallocate during the run
+    state.ready_queue.reserve(list_processes.size() + 1);
+    state.wait_queue.reserve(list_processes.size());
+    state.job_list.reserve(list_processes.size());
+
+    reset_memory();
+    init_io(state.io, config, state.recorder.metrics);
+
+    state.recorder.execution_status = print_exec_header();
+    state.recorder.text_trace = config.text_trace;
+    state.recorder.filter = config.filter;
+}
+
+//Admits the processes arriving at the current time, returns true if any was admitted
+bool admit_arrivals(table_state &state, const sim_config &config) {
+    process_table &table = state.table;
+    bool admitted = false;
+
+    while(state.next_arrival < state.arrivals.size()
+          && table.arrival_time[state.arrivals[state.next_arrival]] == state.current_time) {
+        process_handle process = state.arrivals[state.next_arrival++];
+
+        // Without a free partition the process is never admitted
+        int partition = assign_partition(table.PID[process], table.size[process]);
+        if(partition == -1) {
+            continue;
+        }
+        table.partition_number[process] = partition;
+        table.state[process] = READY;
+        table.time_in_cpu[process] = 0;
+        state.ready_queue.push_back(process);
+        state.job_list.push_back(process);
+        record_transition(state.recorder, state.current_time, table.PID[process], NEW, READY);
+        state.overhead_pending += config.admission_cost;
+        admitted = true;
+    }
+
+    return admitted;
+}
+
+//Moves the running process to the wait queue for its I/O
+void start_io(table_state &state) {
+    process_table &table = state.table;
+    process_handle process = state.running;
+
+    table.state[process] = WAITING;
+    state.wait_queue.push_back(process);
+    submit_io(state.io, table.PID[process], io_length(table, process), table.priority[process], state.current_time);
+    record_transition(state.recorder, state.current_time, table.PID[process], RUNNING, WAITING);
+    state.running = NO_PROCESS;
+}
+
+//Terminates the running process and frees its partition
+void terminate_running(table_state &state) {
+    process_table &table = state.table;
+    process_handle process = state.running;
+
+    record_transition(state.recorder, state.current_time, table.PID[process], RUNNING, TERMINATED);
+    table.remaining_time[process] = 0;
+    table.state[process] = TERMINATED;
+    if(free_partition(table.PID[process])) {
+        table.partition_number[process] = -1;
+    }
+    state.terminated++;
+    state.running = NO_PROCESS;
+}
+
+//Puts the running process back at the front of the ready queue
+void preempt_running(table_state &state) {
+    process_table &table = state.table;
+    process_handle process = state.running;
+
+    table.state[process] = READY;
+    table.time_in_cpu[process] = 0;
+    state.ready_queue.insert(state.ready_queue.begin(), process);
+    record_transition(state.recorder, state.current_time, table.PID[process], RUNNING, READY);
+    state.running = NO_PROCESS;
+}
+
+//Dispatches the process at the back of the (sorted) ready queue
+void dispatch_back(table_state &state) {
+    process_table &table = state.table;
+    process_handle process = state.ready_queue.back();
+    state.ready_queue.pop_back();
+
+    if(table.start_time[process] == -1) {
+        table.start_time[process] = state.current_time;
+    }
+    table.state[process] = RUNNING;
+    state.running = process;
+    record_transition(state.recorder, state.current_time, table.PID[process], READY, RUNNING);
+}
+
+//Returns true once all admitted processes have terminated
+bool simulation_done(const table_state &state) {
+    return !state.job_list.empty() && state.terminated == state.job_list.size();
+}
+
+//Runs a simulation with the table engine, tick advances it by 1ms
+//outputs (optional) is a recorder whose table setting and sinks the run takes over, it receives the transition counts
+//Returns tuple of execution status string, metrics and (empty) memory status
+template<typename Tick>
+std::tuple<std::string, sim_metrics, std::string> run_table_simulation(Tick tick, const std::vector<PCB> &list_processes, const sim_config &config,
+                                                                       sim_recorder *outputs = nullptr) {
+    table_state state;
+    init_table_simulation(state, list_processes, config);
+    if(outputs != nullptr) {
+        state.recorder.text_trace = outputs->text_trace;
+        state.recorder.sinks = outputs->sinks;
+    }
+    track_memory(&state.recorder, &state.current_time);
+
+    while(!simulation_done(state)) {
+        tick(state, config);
+        finish_tick(state);
+
+        if(state.current_time > 100000) {
+            std::cerr << "Simulation timeout at 100000ms" << std::endl;
+            break;
+        }
+    }
+
+    track_memory(nullptr, nullptr);
+    close_execution_table(state.recorder);
+    if(outputs != nullptr) {
+        outputs->transitions = state.recorder.transitions;
+        outputs->matched = state.recorder.matched;
+        outputs->recorded = state.recorder.recorded;
+    }
+
+    return std::make_tuple(state.recorder.execution_status, state.recorder.metrics, std::string());
+}
+
+#endif
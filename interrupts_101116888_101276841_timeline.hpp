@@ -0,0 +1,151 @@
+/**
+ * @file interrupts_101116888_101276841_timeline.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Chrome trace-event (JSON) export for timeline viewers such as Perfetto
+ *
+ * The events are streamed to the file as the transitions happen. Tracks:
+ * - "CPU": one slice per burst of a process on the CPU
+ * - "Ready queue", "I/O" and "Swapped out": one async slice per stay of a process in that state
+ * - "Memory": one thread per partition, one slice per process holding it
+ * Simulated milliseconds are written as trace microseconds * 1000.
+ */
+
+#ifndef INTERRUPTS_TIMELINE_HPP_
+#define INTERRUPTS_TIMELINE_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+
+#include<iterator>
+
+//Track groups ("pid" of the trace-event format)
+enum timeline_tracks {
+    CPU_TRACK = 1,
+    READY_TRACK,
+    IO_TRACK,
+    SWAP_TRACK,
+    MEMORY_TRACK
+};
+
+struct chrome_trace_writer : transition_sink {
+    std::ofstream       file;
+    bool                first_event = true;
+    unsigned int        last_time = 0;
+    int                 on_cpu = -1;                                // PID with an open CPU slice
+    int                 holders[std::size(memory_paritions)];       // PID with an open slice per partition
+
+    void event(const std::string &body) {
+        file << (first_event ? "\n" : ",\n") << "{" << body << "}";
+        first_event = false;
+    }
+
+    static std::string timestamp(unsigned int time) {
+        return std::to_string((std::uint64_t) time * 1000);
+    }
+
+    void slice(const char* phase, int track, int thread, const std::string &name, unsigned int time) {
+        event("\"ph\":\"" + std::string(phase) + "\",\"pid\":" + std::to_string(track) + ",\"tid\":" + std::to_string(thread)
+              + ",\"ts\":" + timestamp(time) + ",\"name\":\"" + name + "\"");
+    }
+
+    //Async slices may overlap, each process gets its own id
+    void async_slice(const char* phase, int track, int PID, const std::string &name, unsigned int time) {
+        event("\"ph\":\"" + std::string(phase) + "\",\"pid\":" + std::to_string(track) + ",\"tid\":1,\"cat\":\""
+              + name + "\",\"id\":" + std::to_string(PID) + ",\"ts\":" + timestamp(time)
+              + ",\"name\":\"P" + std::to_string(PID) + "\"");
+    }
+
+    void metadata(const char* kind, int track, int thread, const std::string &name) {
+        event("\"ph\":\"M\",\"pid\":" + std::to_string(track) + ",\"tid\":" + std::to_string(thread)
+              + ",\"name\":\"" + kind + "\",\"args\":{\"name\":\"" + name + "\"}");
+    }
+
+    //Partition ownership is compared with the table on every allocation and release
+    void record_memory(unsigned int time) override {
+        last_time = time;
+        for(std::size_t i = 0; i < std::size(memory_paritions); i++) {
+            int holder = memory_paritions[i].occupied;
+            if(holder == holders[i]) {
+                continue;
+            }
+            int thread = memory_paritions[i].partition_number;
+            if(holders[i] != -1) {
+                slice("E", MEMORY_TRACK, thread, "P" + std::to_string(holders[i]), time);
+            }
+            if(holder != -1) {
+                slice("B", MEMORY_TRACK, thread, "P" + std::to_string(holder), time);
+            }
+            holders[i] = holder;
+        }
+    }
+
+    void record(unsigned int current_time, int PID, states old_state, states new_state) override {
+        last_time = current_time;
+
+        if(old_state == RUNNING && on_cpu == PID) {
+            slice("E", CPU_TRACK, 1, "P" + std::to_string(PID), current_time);
+            on_cpu = -1;
+        }
+        if(old_state == READY) {
+            async_slice("e", READY_TRACK, PID, "ready", current_time);
+        }
+        if(old_state == WAITING) {
+            async_slice("e", IO_TRACK, PID, "io", current_time);
+        }
+        if(old_state == SUSPENDED) {
+            async_slice("e", SWAP_TRACK, PID, "suspended", current_time);
+        }
+
+        if(new_state == RUNNING) {
+            slice("B", CPU_TRACK, 1, "P" + std::to_string(PID), current_time);
+            on_cpu = PID;
+        }
+        if(new_state == READY) {
+            async_slice("b", READY_TRACK, PID, "ready", current_time);
+        }
+        if(new_state == WAITING) {
+            async_slice("b", IO_TRACK, PID, "io", current_time);
+        }
+        if(new_state == SUSPENDED) {
+            async_slice("b", SWAP_TRACK, PID, "suspended", current_time);
+        }
+    }
+
+    ~chrome_trace_writer() {
+        // Close whatever is still open at the end of the run
+        if(on_cpu != -1) {
+            slice("E", CPU_TRACK, 1, "P" + std::to_string(on_cpu), last_time);
+        }
+        for(std::size_t i = 0; i < std::size(memory_paritions); i++) {
+            if(holders[i] != -1) {
+                slice("E", MEMORY_TRACK, memory_paritions[i].partition_number, "P" + std::to_string(holders[i]), last_time);
+            }
+        }
+        file << "\n]}\n";
+    }
+};
+
+std::shared_ptr<chrome_trace_writer> open_chrome_trace(const std::string &file_name, const sim_config &config) {
+    auto writer = std::make_shared<chrome_trace_writer>();
+    writer->file.open(file_name, std::ios::trunc);
+    if(!writer->file.is_open()) {
+        std::cerr << "Error: Unable to open trace file: " << file_name << std::endl;
+        return nullptr;
+    }
+    std::fill(std::begin(writer->holders), std::end(writer->holders), -1);
+
+    writer->file << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"scheduler\":\"" << config.policy << "\"},\"traceEvents\":[";
+    writer->metadata("process_name", CPU_TRACK, 1, "CPU");
+    writer->metadata("thread_name", CPU_TRACK, 1, "CPU 0");
+    writer->metadata("process_name", READY_TRACK, 1, "Ready queue");
+    writer->metadata("process_name", IO_TRACK, 1, "I/O");
+    writer->metadata("process_name", SWAP_TRACK, 1, "Swapped out");
+    writer->metadata("process_name", MEMORY_TRACK, 1, "Memory");
+    for(const auto &partition : memory_paritions) {
+        writer->metadata("thread_name", MEMORY_TRACK, partition.partition_number,
+                         "Partition " + std::to_string(partition.partition_number) + " (" + std::to_string(partition.size) + "MB)");
+    }
+
+    return writer;
+}
+
+#endif
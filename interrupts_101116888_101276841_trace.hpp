@@ -0,0 +1,173 @@
+/**
+ * @file interrupts_101116888_101276841_trace.hpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Compact binary trace of the state transitions
+ *
+ * File layout:
+ *   header : magic "STRC", version, scheduler name, parameters (strings are length prefixed)
+ *   records: varint(time - previous time), varint(PID), byte(old state << 4 | new state)
+ *
+ * A transition takes 3 bytes in the usual case instead of the 50 byte row of
+ * the execution table. trace_convert renders the file back to the table.
+ */
+
+#ifndef INTERRUPTS_TRACE_HPP_
+#define INTERRUPTS_TRACE_HPP_
+
+#include "interrupts_101116888_101276841.hpp"
+
+const std::uint32_t TRACE_MAGIC = 0x43525453;    // "STRC"
+const std::uint32_t TRACE_VERSION = 1;
+const std::size_t TRACE_BUFFER_SIZE = 1 << 16;
+
+//Description of the run stored at the start of the trace
+struct trace_header {
+    std::string     policy;
+    std::string     parameters;
+};
+
+//------------------------------------ENCODING-----------------------------------------------
+
+void put_varint(std::string &buffer, std::uint64_t value) {
+    while(value >= 0x80) {
+        buffer.push_back((char) ((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((char) value);
+}
+
+void put_trace_string(std::string &buffer, const std::string &value) {
+    put_varint(buffer, value.size());
+    buffer += value;
+}
+
+//Appends the encoding of a transition, previous_time is updated for the next delta
+void encode_record(std::string &buffer, unsigned int &previous_time, const trace_record &record) {
+    put_varint(buffer, record.time - previous_time);
+    put_varint(buffer, (std::uint32_t) record.PID);
+    buffer.push_back((char) ((record.old_state << 4) | record.new_state));
+    previous_time = record.time;
+}
+
+//Parameters of the run as "name=value" pairs
+std::string describe_parameters(const sim_config &config) {
+    std::stringstream buffer;
+    buffer << "quantum=" << config.time_quantum
+           << " adaptive_quantum=" << config.adaptive_quantum
+           << " context_switch=" << config.context_switch_cost
+           << " scheduler_cost=" << config.scheduler_cost
+           << " scheduler_cost_per_ready=" << config.scheduler_cost_per_ready
+           << " admission_cost=" << config.admission_cost
+           << " io_devices=" << config.io_devices
+           << " io_queue=" << (config.io_priority_queue ? "priority" : "fifo")
+           << " swapping=" << config.swapping
+           << " swap_cost=" << config.swap_cost;
+    return buffer.str();
+}
+
+//Buffered writer the engine feeds every transition to
+struct binary_trace_writer : transition_sink {
+    std::ofstream   file;
+    std::string     buffer;
+    unsigned int    previous_time = 0;
+    std::uint64_t   position = 0;       // Bytes written so far (header included)
+
+    void flush() {
+        file.write(buffer.data(), buffer.size());
+        position += buffer.size();
+        buffer.clear();
+    }
+
+    void record(unsigned int current_time, int PID, states old_state, states new_state) override {
+        encode_record(buffer, previous_time, {current_time, PID, old_state, new_state});
+        if(buffer.size() >= TRACE_BUFFER_SIZE) {
+            flush();
+        }
+    }
+
+    ~binary_trace_writer() {
+        flush();
+    }
+};
+
+std::shared_ptr<binary_trace_writer> open_binary_trace(const std::string &file_name, const sim_config &config) {
+    auto writer = std::make_shared<binary_trace_writer>();
+    writer->file.open(file_name, std::ios::binary | std::ios::trunc);
+    if(!writer->file.is_open()) {
+        std::cerr << "Error: Unable to open trace file: " << file_name << std::endl;
+        return nullptr;
+    }
+
+    for(int shift = 0; shift < 32; shift += 8) {
+        writer->buffer.push_back((char) ((TRACE_MAGIC >> shift) & 0xff));
+    }
+    put_varint(writer->buffer, TRACE_VERSION);
+    put_trace_string(writer->buffer, config.policy);
+    put_trace_string(writer->buffer, describe_parameters(config));
+    writer->flush();
+
+    return writer;
+}
+
+//------------------------------------DECODING-----------------------------------------------
+
+//Streams the records of a binary trace without loading the whole file
+struct binary_trace_reader {
+    std::ifstream   file;
+    unsigned int    previous_time = 0;
+
+    bool get_varint(std::uint64_t &value) {
+        value = 0;
+        for(int shift = 0; shift < 64; shift += 7) {
+            int byte = file.get();
+            if(byte == EOF) {
+                return false;
+            }
+            value |= (std::uint64_t) (byte & 0x7f) << shift;
+            if(!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool get_string(std::string &value) {
+        std::uint64_t length;
+        if(!get_varint(length)) {
+            return false;
+        }
+        value.resize(length);
+        file.read(&value[0], length);
+        return (bool) file;
+    }
+
+    bool open(const std::string &file_name, trace_header &header) {
+        file.open(file_name, std::ios::binary);
+        std::uint32_t magic = 0;
+        for(int shift = 0; shift < 32 && file; shift += 8) {
+            magic |= (std::uint32_t) (file.get() & 0xff) << shift;
+        }
+        std::uint64_t version;
+        return file && magic == TRACE_MAGIC && get_varint(version) && version == TRACE_VERSION
+            && get_string(header.policy) && get_string(header.parameters);
+    }
+
+    bool next(trace_record &record) {
+        std::uint64_t delta, PID;
+        if(!get_varint(delta) || !get_varint(PID)) {
+            return false;
+        }
+        int states_byte = file.get();
+        if(states_byte == EOF) {
+            return false;
+        }
+        record.time = previous_time + (unsigned int) delta;
+        record.PID = (int) (std::uint32_t) PID;
+        record.old_state = (states) ((states_byte >> 4) & 0x0f);
+        record.new_state = (states) (states_byte & 0x0f);
+        previous_time = record.time;
+        return true;
+    }
+};
+
+#endif
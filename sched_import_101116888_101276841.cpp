@@ -0,0 +1,83 @@
+/**
+ * @file sched_import_101116888_101276841.cpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Converts a recorded Linux scheduler trace into a simulator input file
+ *
+ * The trace is streamed, each task's line is written as soon as the task
+ * exits. The schedulers can also read a trace directly with --import.
+ */
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_import.hpp"
+
+int main(int argc, char** argv) {
+
+    // Validate command line arguments
+    if(argc < 2) {
+        std::cout << "ERROR!\nExpected at least 1 argument, received " << argc - 1 << std::endl;
+        std::cout << "To run the program, do: ./sched_import <trace.txt> [--format perf|proc] [--tick-us <us>] "
+                  << "[--size <MB>] [--out <file>] [--map <file>]" << std::endl;
+        return -1;
+    }
+
+    std::string format = "perf";
+    std::string out_file, map_file;
+    import_options options;
+
+    for(int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if(option == "--format" && has_value) {
+            format = argv[++i];
+        } else if(option == "--tick-us" && has_value) {
+            options.tick_us = std::max(1, std::atoi(argv[++i]));
+        } else if(option == "--size" && has_value) {
+            options.size = std::max(1, std::atoi(argv[++i]));
+        } else if(option == "--out" && has_value) {
+            out_file = argv[++i];
+        } else if(option == "--map" && has_value) {
+            map_file = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return -1;
+        }
+    }
+
+    std::ifstream input_file(argv[1]);
+    if(!input_file.is_open()) {
+        std::cerr << "Error: Unable to open file: " << argv[1] << std::endl;
+        return -1;
+    }
+
+    std::ofstream output_file, map_output;
+    if(!out_file.empty()) {
+        output_file.open(out_file, std::ios::trunc);
+        if(!output_file.is_open()) {
+            std::cerr << "Error: Unable to open file: " << out_file << std::endl;
+            return -1;
+        }
+    }
+    if(!map_file.empty()) {
+        map_output.open(map_file, std::ios::trunc);
+        if(!map_output.is_open()) {
+            std::cerr << "Error: Unable to open file: " << map_file << std::endl;
+            return -1;
+        }
+        options.map = &map_output;
+    }
+    std::ostream &out = out_file.empty() ? std::cout : output_file;
+
+    std::size_t tasks = 0;
+    bool known = import_sched_trace(input_file, format, options, [&](const std::string &line) {
+        out << line << "\n";
+        tasks++;
+    });
+    if(!known) {
+        std::cerr << "Unknown format: " << format << " (expected perf or proc)" << std::endl;
+        return -1;
+    }
+    std::cerr << "Imported " << tasks << " tasks" << std::endl;
+
+    return 0;
+}
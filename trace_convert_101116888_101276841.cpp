@@ -0,0 +1,98 @@
+/**
+ * @file trace_convert_101116888_101276841.cpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Renders a binary trace back to the execution table
+ *
+ * Without filters the output is identical to the execution_<scheduler>.txt
+ * file of the same run. Records are streamed, the trace is never fully loaded.
+ */
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_trace.hpp"
+
+#include<set>
+
+int main(int argc, char** argv) {
+
+    // Validate command line arguments
+    const std::string usage = "To run the program, do: ./trace_convert <trace.bin> [--pid <PID>[,<PID>...]] "
+                              "[--from <ms>] [--to <ms>] [--out <file>] [--info]";
+    if(argc < 2) {
+        std::cout << "ERROR!\nExpected at least 1 argument, received " << argc - 1 << std::endl;
+        std::cout << usage << std::endl;
+        return -1;
+    }
+
+    std::set<int> pids;
+    unsigned int from = 0;
+    unsigned int to = (unsigned int) -1;
+    std::string out_file;
+    bool info = false;
+
+    for(int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        bool valid = true;
+        if(option == "--pid" && has_value) {
+            std::vector<int> listed;
+            valid = parse_PIDs(argv[++i], listed);
+            pids.insert(listed.begin(), listed.end());
+        } else if(option == "--from" && has_value) {
+            valid = parse_unsigned(argv[++i], from);
+        } else if(option == "--to" && has_value) {
+            valid = parse_unsigned(argv[++i], to);
+        } else if(option == "--out" && has_value) {
+            out_file = argv[++i];
+        } else if(option == "--info") {
+            info = true;
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return -1;
+        }
+        if(!valid) {
+            std::cerr << "Invalid value for " << option << ": " << argv[i] << std::endl;
+            std::cout << usage << std::endl;
+            return -1;
+        }
+    }
+
+    binary_trace_reader reader;
+    trace_header header;
+    if(!reader.open(argv[1], header)) {
+        std::cerr << "Error: " << argv[1] << " is not a binary trace" << std::endl;
+        return -1;
+    }
+
+    if(info) {
+        std::cout << "Scheduler:  " << header.policy << std::endl;
+        std::cout << "Parameters: " << header.parameters << std::endl;
+        return 0;
+    }
+
+    std::ofstream output_file;
+    if(!out_file.empty()) {
+        output_file.open(out_file, std::ios::binary | std::ios::trunc);
+        if(!output_file.is_open()) {
+            std::cerr << "Error: Unable to open file: " << out_file << std::endl;
+            return -1;
+        }
+    }
+    std::ostream &out = out_file.empty() ? std::cout : output_file;
+
+    // Render through the same functions as the engine so the table is byte for byte identical
+    out << print_exec_header();
+    trace_record record;
+    while(reader.next(record)) {
+        if(record.time > to) {
+            break;  // Records are in time order
+        }
+        if(record.time < from || (!pids.empty() && pids.count(record.PID) == 0)) {
+            continue;
+        }
+        out << print_exec_status(record.time, record.PID, record.old_state, record.new_state);
+    }
+    out << print_exec_footer();
+
+    return 0;
+}
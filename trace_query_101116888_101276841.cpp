@@ -0,0 +1,73 @@
+/**
+ * @file trace_query_101116888_101276841.cpp
+ * @author Rounak Mukherjee (101116888), Timur Grigoryev (101276841)
+ * @brief Rebuilds the process table of a run at any time from its binary trace
+ *
+ * Uses the snapshots and time index written next to the trace (<trace>.idx),
+ * only the records after the nearest snapshot are replayed.
+ */
+
+#include "interrupts_101116888_101276841.hpp"
+#include "interrupts_101116888_101276841_snapshot.hpp"
+
+#include<set>
+
+int main(int argc, char** argv) {
+
+    // Validate command line arguments
+    const std::string usage = "To run the program, do: ./trace_query <trace.bin> --at <ms> [--pid <PID>[,<PID>...]]";
+    if(argc < 4) {
+        std::cout << "ERROR!\nExpected at least 3 arguments, received " << argc - 1 << std::endl;
+        std::cout << usage << std::endl;
+        return -1;
+    }
+
+    std::set<int> pids;
+    unsigned int time = 0;
+    bool has_time = false;
+
+    for(int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        bool valid = true;
+        if(option == "--at" && has_value) {
+            valid = parse_unsigned(argv[++i], time);
+            has_time = true;
+        } else if(option == "--pid" && has_value) {
+            std::vector<int> listed;
+            valid = parse_PIDs(argv[++i], listed);
+            pids.insert(listed.begin(), listed.end());
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return -1;
+        }
+        if(!valid) {
+            std::cerr << "Invalid value for " << option << ": " << argv[i] << std::endl;
+            std::cout << usage << std::endl;
+            return -1;
+        }
+    }
+    if(!has_time) {
+        std::cerr << "Expected --at <ms>" << std::endl;
+        return -1;
+    }
+
+    std::vector<PCB> table;
+    std::size_t replayed = 0;
+    if(!query_trace(argv[1], time, table, replayed)) {
+        return -1;
+    }
+
+    if(!pids.empty()) {
+        auto other = std::remove_if(table.begin(), table.end(), [&](const PCB &process) {
+            return pids.count(process.PID) == 0;
+        });
+        table.erase(other, table.end());
+    }
+
+    std::cout << "State at " << time << "ms (" << replayed << " records replayed after the nearest snapshot)" << std::endl;
+    std::cout << print_PCB(table);
+
+    return 0;
+}